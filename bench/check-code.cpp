@@ -0,0 +1,50 @@
+// Compares the latency of mod11_2::do_mod11_2_swar() with the do_mod11_2() loop on single ids.
+// Usage: bench_check-code [millions of calls]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "mod11-2.h"
+
+using namespace idlib;
+
+namespace {
+
+constexpr size_t kIds = 1 << 10;
+
+template <typename F> double measure(F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Each call picks the next id from the previous check code, so the calls can't overlap and the time per call is
+// the latency of one call rather than the throughput of many.
+template <typename F> void run(const char *name, const std::vector<char> &ids, size_t calls, F &&f) {
+    size_t index = 0;
+    unsigned checksum = 0;
+    auto seconds = measure([&] {
+        for (size_t i = 0; i < calls; i++) {
+            auto cc = f(ids.data() + index * 17);
+            checksum += static_cast<unsigned char>(cc);
+            index = (index + static_cast<unsigned char>(cc)) % kIds;
+        }
+    });
+    std::printf("%-16s %.2f ns/call (checksum %u)\n", name, seconds * 1e9 / static_cast<double>(calls), checksum);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t calls = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50) * 1000000;
+    std::mt19937_64 random(42);
+    std::vector<char> ids(kIds * 17);
+    for (auto &c : ids) {
+        c = static_cast<char>('0' + random() % 10);
+    }
+    run("do_mod11_2", ids, calls, [](const char *id) { return mod11_2::do_mod11_2(std::string_view(id, 17)); });
+    run("do_mod11_2_swar", ids, calls, [](const char *id) { return mod11_2::do_mod11_2_swar(id); });
+    return 0;
+}
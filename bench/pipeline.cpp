@@ -0,0 +1,76 @@
+// Compares validate_file() with the plain read-validate-write loop it replaces.
+// Usage: bench_pipeline [lines] [directory]
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "generator.h"
+#include "pipeline.h"
+
+using namespace idlib;
+
+namespace {
+
+template <typename F> double measure(F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t synchronous_loop(const std::string &input, const std::string &output) {
+    std::ifstream in(input, std::ios::binary);
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    std::string line;
+    uint64_t valid = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && validator::decode(line).ok()) {
+            out << line << '\n';
+            ++valid;
+        }
+    }
+    return valid;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t lines = argc > 1 ? std::stoull(argv[1]) : 5'000'000;
+    std::filesystem::path dir = argc > 2 ? argv[2] : std::filesystem::temp_directory_path();
+    auto input = (dir / "idlib_bench_pipeline_input.txt").string();
+    auto output = (dir / "idlib_bench_pipeline_output.txt").string();
+
+    std::mt19937 random(42);
+    generator gen(random);
+    {
+        std::ofstream out(input, std::ios::binary | std::ios::trunc);
+        for (size_t i = 0; i < lines; i++) {
+            out << gen.generate_all_kinds() << '\n';
+        }
+    }
+    auto mb = static_cast<double>(std::filesystem::file_size(input)) / (1 << 20);
+    std::printf("%zu lines, %.1f MiB\n", lines, mb);
+
+    uint64_t valid = 0;
+    auto seconds = measure([&] { valid = synchronous_loop(input, output); });
+    std::printf("%-24s %8.3f s %8.1f MiB/s  valid=%llu\n", "synchronous loop", seconds, mb / seconds,
+                static_cast<unsigned long long>(valid));
+
+    for (bool use_io_uring : {false, true}) {
+        pipeline_options options;
+        options.use_io_uring = use_io_uring;
+        pipeline_stats stats;
+        seconds = measure([&] { stats = validate_file(input, output, options); });
+        std::printf("%-24s %8.3f s %8.1f MiB/s  valid=%llu\n",
+                    stats.used_io_uring ? "pipeline (io_uring)" : "pipeline (pread/pwrite)", seconds, mb / seconds,
+                    static_cast<unsigned long long>(stats.valid));
+    }
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+    return 0;
+}
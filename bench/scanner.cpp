@@ -0,0 +1,60 @@
+// Compares id_scanner with a regex search followed by validator::validate_basic.
+// Usage: bench_scanner [MiB]
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <string>
+
+#include "generator.h"
+#include "scanner.h"
+
+using namespace idlib;
+
+namespace {
+
+template <typename F> double measure(F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Log lines with a timestamp, a request id and an id in one line out of 20.
+std::string make_log(size_t bytes) {
+    std::mt19937_64 random(42);
+    generator gen(random);
+    std::string text;
+    for (uint64_t line = 0; text.size() < bytes; line++) {
+        text += "2024-05-01T12:" + std::to_string(line % 60) + ":07.123Z INFO request=" + std::to_string(random()) +
+                " status=200 latency_ms=" + std::to_string(random() % 1000);
+        if (line % 20 == 0) {
+            text += " user_id=" + gen.generate_all_kinds();
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t mib = argc > 1 ? std::stoull(argv[1]) : 64;
+    auto text = make_log(mib << 20);
+    std::printf("%.1f MiB of log text\n", static_cast<double>(text.size()) / (1 << 20));
+
+    size_t found = 0;
+    auto seconds = measure([&] {
+        std::regex pattern(R"(\b\d{17}[\dXx]\b)");
+        for (std::sregex_iterator it(text.begin(), text.end(), pattern), end; it != end; ++it) {
+            found += validator::validate_basic(it->str());
+        }
+    });
+    std::printf("regex + validate_basic: %zu ids, %.3f s, %.1f MiB/s\n", found, seconds,
+                static_cast<double>(text.size()) / (1 << 20) / seconds);
+
+    found = 0;
+    seconds = measure([&] { found = id_scanner::scan(text).size(); });
+    std::printf("id_scanner:             %zu ids, %.3f s, %.1f MiB/s\n", found, seconds,
+                static_cast<double>(text.size()) / (1 << 20) / seconds);
+    return 0;
+}
@@ -0,0 +1,52 @@
+// Compares static_exhaustor with exhaustor::exhaust_batch() on a template that only masks the date and sequence digits.
+// Usage: bench_static-exhaustor
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+
+#include "candidate-cache.h"
+#include "static-exhaustor.h"
+
+using namespace idlib;
+
+namespace {
+
+template <typename F> double measure(F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+constexpr fixed_string kTemplate = "11010119********[13]*";
+
+} // namespace
+
+int main() {
+    using namespace std::chrono;
+    auto start = year(1900) / 1 / 1;
+    auto end = year(1999) / 12 / 31;
+
+    uint64_t count = 0;
+    uint64_t checksum = 0;
+    auto seconds = measure([&] {
+        candidate_cache::global().clear();
+        pattern tmpl(kTemplate.view());
+        exhaustor::exhaust_batch(
+            std::span(&tmpl, 1),
+            [&](size_t, std::string_view id) {
+                ++count;
+                checksum += id[17];
+            },
+            start, end);
+    });
+    std::printf("exhaustor:        %llu ids, %.3f s (checksum %llu)\n", static_cast<unsigned long long>(count), seconds,
+                static_cast<unsigned long long>(checksum));
+
+    checksum = 0;
+    seconds = measure([&] {
+        count = static_exhaustor<kTemplate>::exhaust([&](std::string_view id) { checksum += id[17]; }, start, end);
+    });
+    std::printf("static_exhaustor: %llu ids, %.3f s (checksum %llu)\n", static_cast<unsigned long long>(count),
+                seconds, static_cast<unsigned long long>(checksum));
+    return 0;
+}
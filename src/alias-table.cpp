@@ -0,0 +1,55 @@
+#include "alias-table.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace idlib {
+
+alias_table::alias_table(std::span<const double> weights) {
+    if (weights.empty() || weights.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("The number of weights must be in [1, 2^32).");
+    }
+    double sum = 0;
+    for (double w : weights) {
+        if (!std::isfinite(w) || w < 0) {
+            throw std::invalid_argument("Weights must be finite and non-negative.");
+        }
+        sum += w;
+    }
+    if (sum <= 0) {
+        throw std::invalid_argument("The sum of the weights must be positive.");
+    }
+
+    auto n = weights.size();
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < n; i++) {
+        scaled[i] = weights[i] * static_cast<double>(n) / sum;
+        (scaled[i] < 1 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+
+    // A column that keeps itself with probability 1 aliases to itself, so the threshold never has to hold 2^32.
+    entries_.resize(n);
+    constexpr double kScale = 4294967296.0;
+    while (!small.empty() && !large.empty()) {
+        auto s = small.back();
+        auto l = large.back();
+        small.pop_back();
+        entries_[s] = {static_cast<uint32_t>(std::min(scaled[s] * kScale, kScale - 1)), l};
+        scaled[l] -= 1 - scaled[s];
+        if (scaled[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Whatever is left is 1 up to rounding error.
+    for (auto i : large) {
+        entries_[i] = {0, i};
+    }
+    for (auto i : small) {
+        entries_[i] = {0, i};
+    }
+}
+
+} // namespace idlib
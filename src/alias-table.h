@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace idlib {
+
+/**
+ * @brief A discrete distribution sampled in O(1) with Vose's alias method.
+ *
+ * The table is built once in O(n). Every draw takes a single 64-bit random number: the high half picks a column
+ * and the low half decides between the column itself and its alias.
+ */
+class alias_table {
+
+    struct entry {
+        uint32_t threshold; // the column is kept if the low 32 random bits are below this
+        uint32_t alias;
+    };
+
+    std::vector<entry> entries_{};
+
+  public:
+    alias_table() = default;
+
+    /**
+     * @brief Construct a new alias_table object.
+     *
+     * @param weights The relative weight of each index, they don't have to sum to 1.
+     * @throw std::invalid_argument if weights is empty, has a negative or non-finite weight or sums to 0.
+     */
+    explicit alias_table(std::span<const double> weights);
+
+    [[nodiscard]] size_t size() const noexcept { return entries_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return entries_.empty(); }
+
+    /**
+     * @brief Draw an index with probability proportional to its weight.
+     *
+     * @param random The random number engine.
+     * @return size_t An index in [0, size()), the table must not be empty.
+     */
+    template <typename Random> size_t operator()(Random &random) const {
+        uint64_t bits = std::uniform_int_distribution<uint64_t>()(random);
+        auto column = static_cast<uint32_t>(((bits >> 32) * entries_.size()) >> 32);
+        const auto &e = entries_[column];
+        return static_cast<uint32_t>(bits) < e.threshold ? column : e.alias;
+    }
+};
+
+} // namespace idlib
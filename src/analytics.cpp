@@ -0,0 +1,104 @@
+#include "analytics.h"
+#include "calendar.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace idlib {
+
+namespace {
+
+struct fields {
+    unsigned province;
+    int year;
+    unsigned month;
+    unsigned day;
+    uint8_t sex;
+};
+
+#if defined(__SSSE3__)
+
+// pmaddubsw with the weights 10, 1 turns every pair of digits into a two-digit number, the 16 bytes at the start of
+// the record give province, city, district, century, year, month, day and registry code in the 8 lanes.
+inline fields parse(const id_record &record) noexcept {
+    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(record.data()));
+    auto pairs = _mm_maddubs_epi16(_mm_sub_epi8(bytes, _mm_set1_epi8('0')), _mm_set1_epi16(0x010a));
+    return {static_cast<unsigned>(_mm_extract_epi16(pairs, 0)),
+            _mm_extract_epi16(pairs, 3) * 100 + _mm_extract_epi16(pairs, 4),
+            static_cast<unsigned>(_mm_extract_epi16(pairs, 5)), static_cast<unsigned>(_mm_extract_epi16(pairs, 6)),
+            static_cast<uint8_t>(record[detail::kSequenceCodeIndex] & 1)};
+}
+
+#else
+
+inline unsigned pair(const id_record &record, size_t i) noexcept {
+    return static_cast<unsigned>(record[i] - '0') * 10 + static_cast<unsigned>(record[i + 1] - '0');
+}
+
+inline fields parse(const id_record &record) noexcept {
+    return {pair(record, 0), static_cast<int>(pair(record, 6) * 100 + pair(record, 8)), pair(record, 10),
+            pair(record, 12), static_cast<uint8_t>(record[detail::kSequenceCodeIndex] & 1)};
+}
+
+#endif
+
+// The age at the reference date, one less if the birthday hasn't come yet that year.
+inline int age(const fields &f, int year, unsigned month_day) noexcept {
+    return year - f.year - (month_day < f.month * 100 + f.day);
+}
+
+} // namespace
+
+void extract_fields(std::span<const id_record> records, int32_t *date_of_birth, uint8_t *sex,
+                    uint8_t *province) noexcept {
+    for (size_t i = 0; i < records.size(); i++) {
+        auto f = parse(records[i]);
+        if (date_of_birth) {
+            date_of_birth[i] = detail::days_from_civil(f.year, std::clamp(f.month, 1u, 12u), f.day);
+        }
+        if (sex) {
+            sex[i] = f.sex;
+        }
+        if (province) {
+            province[i] = static_cast<uint8_t>(f.province);
+        }
+    }
+}
+
+void extract_ages(std::span<const id_record> records, std::chrono::year_month_day reference, int16_t *ages) noexcept {
+    auto year = static_cast<int>(reference.year());
+    auto month_day = static_cast<unsigned>(reference.month()) * 100 + static_cast<unsigned>(reference.day());
+    for (size_t i = 0; i < records.size(); i++) {
+        ages[i] = static_cast<int16_t>(age(parse(records[i]), year, month_day));
+    }
+}
+
+age_histogram histogram(std::span<const id_record> records, std::chrono::year_month_day reference, int bucket_years,
+                        size_t buckets) {
+    if (bucket_years <= 0 || buckets == 0) {
+        throw std::invalid_argument("The bucket width and count must be positive.");
+    }
+    age_histogram result;
+    result.bucket_years = bucket_years;
+    result.buckets = buckets;
+    result.counts.resize(age_histogram::kProvinces * 2 * buckets);
+    auto year = static_cast<int>(reference.year());
+    auto month_day = static_cast<unsigned>(reference.month()) * 100 + static_cast<unsigned>(reference.day());
+    for (const auto &record : records) {
+        auto f = parse(record);
+        auto a = age(f, year, month_day);
+        if (a < 0) {
+            ++result.skipped;
+            continue;
+        }
+        auto bucket = std::min(static_cast<size_t>(a / bucket_years), buckets - 1);
+        ++result.counts[((f.province % age_histogram::kProvinces) * 2 + f.sex) * buckets + bucket];
+    }
+    return result;
+}
+
+} // namespace idlib
@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "details.h"
+
+namespace idlib {
+
+//
+// Batch kernels over stored ids, for analytics on ids that were validated beforehand. A malformed record gives
+// meaningless values for its own row but never affects the others.
+//
+
+/**
+ * @brief Extract the date of birth, sex and province of every record into columns.
+ *
+ * The digits are converted 16 bytes at a time with SSSE3 where available.
+ *
+ * @param records The ids.
+ * @param date_of_birth If not null, receives the day serial (days since 1970-01-01) of the date of birth.
+ * @param sex If not null, receives 1 for male and 0 for female.
+ * @param province If not null, receives the first two digits of the region code as a number, e.g. 11 for Beijing.
+ */
+void extract_fields(std::span<const id_record> records, int32_t *date_of_birth, uint8_t *sex,
+                    uint8_t *province) noexcept;
+
+/**
+ * @brief Compute the age in whole years of every record at a reference date.
+ *
+ * @param ages Receives the age, negative if the id was born after the reference date.
+ */
+void extract_ages(std::span<const id_record> records, std::chrono::year_month_day reference, int16_t *ages) noexcept;
+
+/**
+ * @brief Counts of ids by province, sex and age bucket.
+ */
+struct age_histogram {
+    static constexpr size_t kProvinces = 100;
+
+    int bucket_years{};
+    size_t buckets{};
+    uint64_t skipped{};            // ids born after the reference date
+    std::vector<uint64_t> counts{}; // indexed by (province * 2 + sex) * buckets + bucket
+
+    [[nodiscard]] uint64_t at(size_t province, uint8_t sex, size_t bucket) const noexcept {
+        return counts[(province * 2 + sex) * buckets + bucket];
+    }
+};
+
+/**
+ * @brief Count ids by province, sex and age bucket in a single pass without materializing the columns.
+ *
+ * @param reference The date the ages are computed at.
+ * @param bucket_years The width of an age bucket in years.
+ * @param buckets The number of buckets, the last one also counts every older age.
+ * @throw std::invalid_argument if bucket_years or buckets is not positive.
+ */
+age_histogram histogram(std::span<const id_record> records, std::chrono::year_month_day reference,
+                        int bucket_years = 10, size_t buckets = 12);
+
+} // namespace idlib
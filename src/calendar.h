@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace idlib::detail {
+
+// A day serial is the number of days since 1970-01-01, the same epoch as std::chrono::sys_days.
+
+constexpr int32_t to_day_serial(const std::chrono::year_month_day &ymd) {
+    return static_cast<int32_t>(std::chrono::sys_days(ymd).time_since_epoch().count());
+}
+
+constexpr std::chrono::year_month_day from_day_serial(int32_t serial) {
+    return std::chrono::year_month_day{std::chrono::sys_days(std::chrono::days(serial))};
+}
+
+// The day serial of a civil date without going through std::chrono, for batch kernels. The date must be valid.
+constexpr int32_t days_from_civil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const auto yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int32_t>(doe) - 719468;
+}
+
+constexpr unsigned last_day_of_month(int y, unsigned m) {
+    constexpr unsigned kLastDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (m == 2 && y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) {
+        return 29;
+    }
+    return kLastDays[m - 1];
+}
+
+/**
+ * @brief Enumerates the dates in [start, end] whose yyyymmdd digits are allowed by a per-position digit mask.
+ *
+ * Bit d of masks[i] is set if digit d is allowed at position i of the yyyymmdd string. The enumerator walks the
+ * days as serial numbers, skipping a whole year or month as soon as its digits are rejected, and writes the
+ * matched digits straight into the caller's buffer.
+ */
+class date_enumerator {
+
+    std::array<uint16_t, 8> masks_{};
+    int32_t serial_{};
+    int32_t end_serial_{};
+    int year_{};
+    unsigned month_{};
+    unsigned day_{};
+
+    [[nodiscard]] constexpr bool allowed(size_t pos, unsigned digit) const { return (masks_[pos] >> digit) & 1; }
+
+    [[nodiscard]] constexpr bool year_matched() const {
+        return year_ >= 0 && year_ <= 9999 && allowed(0, year_ / 1000) && allowed(1, year_ / 100 % 10) &&
+               allowed(2, year_ / 10 % 10) && allowed(3, year_ % 10);
+    }
+
+    [[nodiscard]] constexpr bool month_matched() const { return allowed(4, month_ / 10) && allowed(5, month_ % 10); }
+
+    [[nodiscard]] constexpr bool day_matched() const { return allowed(6, day_ / 10) && allowed(7, day_ % 10); }
+
+    constexpr void seek(int y, unsigned m, unsigned d) {
+        using namespace std::chrono;
+        year_ = y;
+        month_ = m;
+        day_ = d;
+        serial_ = to_day_serial(year{y} / month{m} / day{d});
+    }
+
+    constexpr void advance_day() {
+        ++serial_;
+        if (++day_ > last_day_of_month(year_, month_)) {
+            day_ = 1;
+            if (++month_ > 12) {
+                month_ = 1;
+                ++year_;
+            }
+        }
+    }
+
+  public:
+    constexpr date_enumerator(const std::array<uint16_t, 8> &masks, const std::chrono::year_month_day &start,
+                              const std::chrono::year_month_day &end)
+        : masks_(masks), end_serial_(to_day_serial(end)) {
+        seek((int)start.year(), (unsigned)start.month(), (unsigned)start.day());
+    }
+
+    /**
+     * @brief Move to the next matched date.
+     *
+     * @param out The buffer receiving the 8 yyyymmdd digits.
+     * @return true if a date was written, false if the range is exhausted.
+     */
+    constexpr bool next(char *out) {
+        while (serial_ <= end_serial_) {
+            if (!year_matched()) {
+                seek(year_ + 1, 1, 1);
+                continue;
+            }
+            if (!month_matched()) {
+                if (month_ == 12) {
+                    seek(year_ + 1, 1, 1);
+                } else {
+                    seek(year_, month_ + 1, 1);
+                }
+                continue;
+            }
+            if (!day_matched()) {
+                advance_day();
+                continue;
+            }
+            out[0] = static_cast<char>(year_ / 1000 + '0');
+            out[1] = static_cast<char>(year_ / 100 % 10 + '0');
+            out[2] = static_cast<char>(year_ / 10 % 10 + '0');
+            out[3] = static_cast<char>(year_ % 10 + '0');
+            out[4] = static_cast<char>(month_ / 10 + '0');
+            out[5] = static_cast<char>(month_ % 10 + '0');
+            out[6] = static_cast<char>(day_ / 10 + '0');
+            out[7] = static_cast<char>(day_ % 10 + '0');
+            advance_day();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Get the day serial of the date that next() will examine.
+     */
+    [[nodiscard]] constexpr int32_t serial() const noexcept { return serial_; }
+};
+
+} // namespace idlib::detail
@@ -0,0 +1,121 @@
+#include "candidate-cache.h"
+
+#include <stdexcept>
+
+namespace idlib {
+
+size_t detail::field_table::size_in_bytes() const noexcept {
+    size_t bytes = sizeof(field_table) + values.capacity() * sizeof(std::string) + sums.capacity() * sizeof(int);
+    for (auto &value : values) {
+        // Short strings live inside the object.
+        if (value.capacity() > std::string().capacity()) {
+            bytes += value.capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+size_t candidate_cache::key_hash::operator()(const key &k) const noexcept {
+    // FNV-1a over the fields.
+    uint64_t hash = 14695981039346656037ULL;
+    auto feed = [&](uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+    feed(static_cast<uint64_t>(k.kind));
+    for (auto mask : k.masks) {
+        feed(mask);
+    }
+    feed(static_cast<uint32_t>(k.date_start));
+    feed(static_cast<uint32_t>(k.date_end));
+    return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+candidate_cache::candidate_cache(size_t capacity, size_t shards)
+    : shards_(new shard[shards]), shard_count_(shards), shard_capacity_(shards ? capacity / shards : 0) {
+    if (shards == 0) {
+        throw std::invalid_argument("There must be at least one shard.");
+    }
+}
+
+candidate_cache::shard &candidate_cache::shard_of(const key &k) const noexcept {
+    return shards_[key_hash()(k) % shard_count_];
+}
+
+void candidate_cache::evict(shard &s, size_t capacity) {
+    while (s.bytes > capacity && !s.lru.empty()) {
+        auto &victim = s.lru.back();
+        s.bytes -= victim.bytes;
+        s.index.erase(victim.k);
+        s.lru.pop_back();
+        ++s.counters.evictions;
+    }
+}
+
+candidate_cache::value candidate_cache::get_or_build(const key &k, const std::function<value()> &build) {
+    auto &s = shard_of(k);
+    {
+        std::lock_guard lock(s.mutex);
+        auto it = s.index.find(k);
+        if (it != s.index.end()) {
+            ++s.counters.hits;
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+            return it->second->table;
+        }
+        ++s.counters.misses;
+    }
+    auto table = build();
+    auto bytes = table->size_in_bytes();
+    auto capacity = shard_capacity_.load(std::memory_order_relaxed);
+
+    std::lock_guard lock(s.mutex);
+    if (bytes > capacity) {
+        return table;
+    }
+    auto it = s.index.find(k);
+    if (it != s.index.end()) {
+        s.bytes -= it->second->bytes;
+        s.lru.erase(it->second);
+    }
+    s.lru.push_front({k, table, bytes});
+    s.index[k] = s.lru.begin();
+    s.bytes += bytes;
+    evict(s, capacity);
+    return table;
+}
+
+void candidate_cache::set_capacity(size_t capacity) {
+    shard_capacity_.store(capacity / shard_count_, std::memory_order_relaxed);
+    for (size_t i = 0; i < shard_count_; i++) {
+        std::lock_guard lock(shards_[i].mutex);
+        evict(shards_[i], capacity / shard_count_);
+    }
+}
+
+void candidate_cache::clear() {
+    for (size_t i = 0; i < shard_count_; i++) {
+        std::lock_guard lock(shards_[i].mutex);
+        shards_[i].lru.clear();
+        shards_[i].index.clear();
+        shards_[i].bytes = 0;
+    }
+}
+
+candidate_cache::stats candidate_cache::statistics() const {
+    stats result;
+    for (size_t i = 0; i < shard_count_; i++) {
+        std::lock_guard lock(shards_[i].mutex);
+        result.hits += shards_[i].counters.hits;
+        result.misses += shards_[i].counters.misses;
+        result.evictions += shards_[i].counters.evictions;
+        result.entries += shards_[i].lru.size();
+        result.bytes += shards_[i].bytes;
+    }
+    return result;
+}
+
+candidate_cache &candidate_cache::global() {
+    static candidate_cache cache(64 << 20);
+    return cache;
+}
+
+} // namespace idlib
@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace idlib {
+
+namespace detail {
+
+/**
+ * @brief The candidates of one field of a template and their weighted sums, immutable once built.
+ */
+struct field_table {
+    std::vector<std::string> values;
+    std::vector<int> sums;
+
+    [[nodiscard]] size_t size_in_bytes() const noexcept;
+};
+
+} // namespace detail
+
+/**
+ * @brief A thread-safe, bounded cache of exhausted field candidates, shared by every exhaustor in the process.
+ *
+ * Candidate lists only depend on the masks of their field and, for the date of birth, the date range, so templates
+ * that recur across requests reuse them instead of enumerating the region codes or dates again. The cache is split
+ * into shards by key hash, each with its own lock and LRU list, and evicts least recently used tables once the bytes
+ * of a shard exceed its share of the capacity.
+ */
+class candidate_cache {
+
+  public:
+    enum class field : uint8_t { kRegionCode, kDateOfBirth, kRegistryCode };
+
+    struct key {
+        field kind{};
+        std::array<uint16_t, 8> masks{}; // the masks of the field's positions, unused ones are 0
+        int32_t date_start{};            // day serials of the date range, 0 for other fields
+        int32_t date_end{};
+
+        bool operator==(const key &) const noexcept = default;
+    };
+
+    struct key_hash {
+        size_t operator()(const key &k) const noexcept;
+    };
+
+    using value = std::shared_ptr<const detail::field_table>;
+
+    struct stats {
+        uint64_t hits{};
+        uint64_t misses{};
+        uint64_t evictions{};
+        uint64_t entries{};
+        uint64_t bytes{};
+    };
+
+  private:
+    struct entry {
+        key k;
+        value table;
+        size_t bytes;
+    };
+
+    struct alignas(64) shard {
+        std::mutex mutex;
+        std::list<entry> lru; // most recently used first
+        std::unordered_map<key, std::list<entry>::iterator, key_hash> index;
+        size_t bytes{};
+        stats counters{};
+    };
+
+    std::unique_ptr<shard[]> shards_;
+    size_t shard_count_;
+    std::atomic<size_t> shard_capacity_;
+
+    shard &shard_of(const key &k) const noexcept;
+    void evict(shard &s, size_t capacity);
+
+  public:
+    /**
+     * @brief Construct a new candidate_cache object.
+     *
+     * @param capacity The total size of the cached tables in bytes, 0 disables caching.
+     * @param shards The number of shards.
+     * @throw std::invalid_argument if shards is 0.
+     */
+    explicit candidate_cache(size_t capacity, size_t shards = 16);
+
+    /**
+     * @brief Get a table, building and inserting it on a miss.
+     *
+     * The build runs outside of the lock, two threads that miss the same key at once both build it and the later
+     * insert wins. A table larger than a shard's capacity is returned without being cached.
+     */
+    value get_or_build(const key &k, const std::function<value()> &build);
+
+    /**
+     * @brief Change the capacity, evicting tables if it shrinks.
+     */
+    void set_capacity(size_t capacity);
+
+    void clear();
+
+    [[nodiscard]] stats statistics() const;
+
+    /**
+     * @brief The cache used by exhaustor, 64 MiB by default.
+     */
+    static candidate_cache &global();
+};
+
+} // namespace idlib
@@ -0,0 +1,389 @@
+#include "column-store.h"
+#include "calendar.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace idlib {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x434c4449; // "IDLC"
+constexpr uint32_t kVersion = 1;
+
+struct file_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t block_rows;
+    uint32_t reserved;
+};
+
+struct block_header {
+    uint32_t rows;
+    int32_t date_base;
+    uint16_t dict_size;
+    uint16_t serial_base;
+    uint8_t region_bits;
+    uint8_t date_bits;
+    uint8_t serial_bits;
+    uint8_t reserved;
+};
+
+struct file_footer {
+    uint64_t index_offset;
+    uint32_t block_count;
+    uint32_t magic;
+};
+
+static_assert(sizeof(file_header) == 16 && sizeof(block_header) == 16 && sizeof(file_footer) == 16);
+static_assert(sizeof(column_reader::block_info) == 24);
+
+constexpr size_t kCheckBits = 4;
+
+constexpr size_t padded(size_t size) noexcept { return (size + 7) / 8 * 8; }
+
+constexpr size_t word_count(size_t rows, size_t bits) noexcept { return (rows * bits + 63) / 64; }
+
+constexpr uint8_t bits_for(uint32_t max_value) noexcept {
+    return static_cast<uint8_t>(std::bit_width(max_value));
+}
+
+void pack_bits(const std::vector<uint32_t> &values, unsigned bits, std::vector<uint64_t> &words) {
+    words.assign(word_count(values.size(), bits), 0);
+    if (bits == 0) {
+        return;
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        auto pos = i * bits;
+        auto word = pos / 64;
+        auto shift = pos % 64;
+        words[word] |= uint64_t{values[i]} << shift;
+        if (shift + bits > 64) {
+            words[word + 1] |= uint64_t{values[i]} >> (64 - shift);
+        }
+    }
+}
+
+// Reads bit-packed values from a stream of little-endian 64-bit words that may be unaligned.
+class bit_reader {
+
+    const uint8_t *words_;
+    unsigned bits_;
+    uint64_t mask_;
+
+    [[nodiscard]] uint64_t word(size_t index) const noexcept {
+        uint64_t value;
+        std::memcpy(&value, words_ + index * 8, 8);
+        return value;
+    }
+
+  public:
+    bit_reader(const uint8_t *words, unsigned bits) noexcept
+        : words_(words), bits_(bits), mask_(bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1) {}
+
+    [[nodiscard]] uint32_t operator[](size_t index) const noexcept {
+        if (bits_ == 0) {
+            return 0;
+        }
+        auto pos = index * bits_;
+        auto shift = pos % 64;
+        auto value = word(pos / 64) >> shift;
+        if (shift + bits_ > 64) {
+            value |= word(pos / 64 + 1) << (64 - shift);
+        }
+        return static_cast<uint32_t>(value & mask_);
+    }
+};
+
+template <typename T> T load(const uint8_t *data) noexcept {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+void write_digits(char *out, uint32_t value, size_t count) noexcept {
+    for (size_t i = count; i-- > 0;) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace
+
+column_filter &column_filter::region_prefix(std::string_view prefix) {
+    auto begin = kRegionCodes.begin();
+    auto end = kRegionCodes.begin() + detail::kRegionCodeCount;
+    auto first = std::lower_bound(begin, end, prefix);
+    auto last = first;
+    while (last != end && last->starts_with(prefix)) {
+        ++last;
+    }
+    if (first == last) {
+        throw std::invalid_argument("No region code starts with the prefix.");
+    }
+    region_first = static_cast<uint16_t>(first - begin);
+    region_last = static_cast<uint16_t>(last - begin - 1);
+    return *this;
+}
+
+column_filter &column_filter::date_range(std::chrono::year_month_day first, std::chrono::year_month_day last) {
+    date_first = detail::to_day_serial(first);
+    date_last = detail::to_day_serial(last);
+    return *this;
+}
+
+column_writer::column_writer(const std::string &path, uint32_t block_rows)
+    : out_(path, std::ios::binary | std::ios::trunc), block_rows_(block_rows) {
+    if (!out_) {
+        throw std::runtime_error("Failed to create " + path);
+    }
+    if (block_rows_ == 0) {
+        throw std::invalid_argument("The number of rows per block must be positive.");
+    }
+    file_header header{kMagic, kVersion, block_rows_, 0};
+    write_bytes(&header, sizeof(header));
+}
+
+column_writer::~column_writer() {
+    if (!finished_) {
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+}
+
+void column_writer::write_bytes(const void *data, size_t size) {
+    out_.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    if (!out_) {
+        throw std::runtime_error("Failed to write the columnar file.");
+    }
+    offset_ += size;
+}
+
+void column_writer::write(std::string_view id) {
+    using namespace std::chrono;
+    if (id.size() != 18) {
+        throw std::invalid_argument("The length of the id must be 18.");
+    }
+    auto region = detail::region_index(id.substr(detail::kRegionCodeStart, detail::kRegionCodeLength));
+    if (region < 0) {
+        throw std::invalid_argument("The region code is invalid.");
+    }
+    uint32_t numbers[2] = {};
+    for (size_t i = detail::kDateOfBirthStart; i < detail::kCheckCodeIndex; i++) {
+        auto digit = static_cast<uint32_t>(id[i] - '0');
+        if (digit > 9) {
+            throw std::invalid_argument("The id must only contain digits, 'X' and 'x'.");
+        }
+        auto &number = numbers[i >= detail::kRegistryCodeStart];
+        number = number * 10 + digit;
+    }
+    auto date = year(static_cast<int>(numbers[0] / 10000)) / month(numbers[0] / 100 % 100) / day(numbers[0] % 100);
+    if (!date.ok()) {
+        throw std::invalid_argument("The date of birth is invalid.");
+    }
+    auto cc = id[detail::kCheckCodeIndex];
+    uint8_t check_code;
+    if (cc >= '0' && cc <= '9') {
+        check_code = static_cast<uint8_t>(cc - '0');
+    } else if (cc == 'X' || cc == 'x') {
+        check_code = 10;
+    } else {
+        throw std::invalid_argument("The id must only contain digits, 'X' and 'x'.");
+    }
+    regions_.push_back(static_cast<uint16_t>(region));
+    dates_.push_back(detail::to_day_serial(date));
+    serials_.push_back(static_cast<uint16_t>(numbers[1]));
+    check_codes_.push_back(check_code);
+    if (regions_.size() == block_rows_) {
+        flush_block();
+    }
+}
+
+void column_writer::flush_block() {
+    if (regions_.empty()) {
+        return;
+    }
+    auto rows = static_cast<uint32_t>(regions_.size());
+    auto [region_min, region_max] = std::minmax_element(regions_.begin(), regions_.end());
+    auto [date_min, date_max] = std::minmax_element(dates_.begin(), dates_.end());
+    auto serial_min = *std::min_element(serials_.begin(), serials_.end());
+    auto serial_max = *std::max_element(serials_.begin(), serials_.end());
+
+    std::vector<uint16_t> dict(regions_);
+    std::sort(dict.begin(), dict.end());
+    dict.erase(std::unique(dict.begin(), dict.end()), dict.end());
+
+    block_header header{};
+    header.rows = rows;
+    header.date_base = *date_min;
+    header.dict_size = static_cast<uint16_t>(dict.size());
+    header.serial_base = serial_min;
+    header.region_bits = bits_for(static_cast<uint32_t>(dict.size() - 1));
+    header.date_bits = bits_for(static_cast<uint32_t>(*date_max - *date_min));
+    header.serial_bits = bits_for(static_cast<uint32_t>(serial_max - serial_min));
+
+    column_reader::block_info info{offset_, rows, *region_min, *region_max, *date_min, *date_max};
+    index_.insert(index_.end(), reinterpret_cast<const uint8_t *>(&info),
+                  reinterpret_cast<const uint8_t *>(&info) + sizeof(info));
+
+    write_bytes(&header, sizeof(header));
+    auto dict_bytes = dict.size() * sizeof(uint16_t);
+    write_bytes(dict.data(), dict_bytes);
+    static constexpr uint8_t kZeros[8] = {};
+    write_bytes(kZeros, padded(dict_bytes) - dict_bytes);
+
+    std::vector<uint32_t> values(rows);
+    std::vector<uint64_t> words;
+    auto write_column = [&](unsigned bits) {
+        pack_bits(values, bits, words);
+        write_bytes(words.data(), words.size() * sizeof(uint64_t));
+    };
+    for (size_t i = 0; i < rows; i++) {
+        values[i] = static_cast<uint32_t>(std::lower_bound(dict.begin(), dict.end(), regions_[i]) - dict.begin());
+    }
+    write_column(header.region_bits);
+    for (size_t i = 0; i < rows; i++) {
+        values[i] = static_cast<uint32_t>(dates_[i] - header.date_base);
+    }
+    write_column(header.date_bits);
+    for (size_t i = 0; i < rows; i++) {
+        values[i] = serials_[i] - header.serial_base;
+    }
+    write_column(header.serial_bits);
+    for (size_t i = 0; i < rows; i++) {
+        values[i] = check_codes_[i];
+    }
+    write_column(kCheckBits);
+
+    ++block_count_;
+    regions_.clear();
+    dates_.clear();
+    serials_.clear();
+    check_codes_.clear();
+}
+
+void column_writer::finish() {
+    if (finished_) {
+        return;
+    }
+    flush_block();
+    file_footer footer{offset_, block_count_, kMagic};
+    write_bytes(index_.data(), index_.size());
+    write_bytes(&footer, sizeof(footer));
+    out_.flush();
+    if (!out_) {
+        throw std::runtime_error("Failed to write the columnar file.");
+    }
+    out_.close();
+    finished_ = true;
+}
+
+column_reader::column_reader(const std::string &path) : file_(path) {
+    auto data = file_.data();
+    auto size = file_.size();
+    if (size < sizeof(file_header) + sizeof(file_footer)) {
+        throw std::runtime_error("The columnar file is truncated.");
+    }
+    auto header = load<file_header>(data);
+    auto footer = load<file_footer>(data + size - sizeof(file_footer));
+    if (header.magic != kMagic || footer.magic != kMagic || header.version != kVersion) {
+        throw std::runtime_error("The file is not a columnar id file.");
+    }
+    // Compared by subtraction, offsets from a corrupted footer could wrap around in a sum.
+    if (footer.index_offset > size - sizeof(file_footer) ||
+        (size - sizeof(file_footer) - footer.index_offset) != uint64_t{footer.block_count} * sizeof(block_info)) {
+        throw std::runtime_error("The block index of the columnar file is corrupted.");
+    }
+    blocks_.resize(footer.block_count);
+    std::memcpy(blocks_.data(), data + footer.index_offset, blocks_.size() * sizeof(block_info));
+    for (auto &block : blocks_) {
+        if (block.offset > footer.index_offset || footer.index_offset - block.offset < sizeof(block_header)) {
+            throw std::runtime_error("The block index of the columnar file is corrupted.");
+        }
+        size_ += block.rows;
+    }
+}
+
+uint64_t column_reader::size() const noexcept { return size_; }
+
+const std::vector<column_reader::block_info> &column_reader::blocks() const noexcept { return blocks_; }
+
+void column_reader::read_block(size_t index, std::vector<id_record> &out) const {
+    column_filter all{};
+    scan_block(index, all, [&](const id_record &id) { out.push_back(id); });
+}
+
+uint64_t column_reader::scan(const column_filter &filter,
+                             const std::function<void(const id_record &)> &callback) const {
+    uint64_t count = 0;
+    for (size_t i = 0; i < blocks_.size(); i++) {
+        auto &block = blocks_[i];
+        if (block.region_last < filter.region_first || block.region_first > filter.region_last ||
+            block.date_last < filter.date_first || block.date_first > filter.date_last) {
+            continue;
+        }
+        count += scan_block(i, filter, callback);
+    }
+    return count;
+}
+
+uint64_t column_reader::scan_block(size_t index, const column_filter &filter,
+                                   const std::function<void(const id_record &)> &callback) const {
+    if (index >= blocks_.size()) {
+        throw std::out_of_range("The block index is out of range.");
+    }
+    // The sections are laid out as offsets and checked against the size of the file before any pointer is formed, so
+    // a truncated or crafted file can't point past the mapping.
+    uint64_t offset = blocks_[index].offset;
+    auto section = [&](uint64_t bytes) {
+        if (offset > file_.size() || bytes > file_.size() - offset) {
+            throw std::runtime_error("The columnar file is truncated.");
+        }
+        auto start = file_.data() + offset;
+        offset += bytes;
+        return start;
+    };
+    auto header = load<block_header>(section(sizeof(block_header)));
+    if (header.region_bits > 32 || header.date_bits > 32 || header.serial_bits > 32) {
+        throw std::runtime_error("The block header of the columnar file is corrupted.");
+    }
+    // At most 2^32 rows of 32 bits each, the sizes can't overflow 64 bits.
+    auto column_bytes = [&](unsigned bits) { return (uint64_t{header.rows} * bits + 63) / 64 * 8; };
+    auto dict = section(padded(header.dict_size * sizeof(uint16_t)));
+    bit_reader regions(section(column_bytes(header.region_bits)), header.region_bits);
+    bit_reader dates(section(column_bytes(header.date_bits)), header.date_bits);
+    bit_reader serials(section(column_bytes(header.serial_bits)), header.serial_bits);
+    bit_reader check_codes(section(column_bytes(kCheckBits)), kCheckBits);
+
+    uint64_t count = 0;
+    id_record id{};
+    for (size_t row = 0; row < header.rows; row++) {
+        auto code = regions[row];
+        auto region = code < header.dict_size ? load<uint16_t>(dict + code * sizeof(uint16_t)) : uint16_t{0xffff};
+        if (region >= detail::kRegionCodeCount) {
+            throw std::runtime_error("The region column of the columnar file is corrupted.");
+        }
+        auto date = header.date_base + static_cast<int32_t>(dates[row]);
+        if (region < filter.region_first || region > filter.region_last || date < filter.date_first ||
+            date > filter.date_last) {
+            continue;
+        }
+        kRegionCodes[region].copy(id.data() + detail::kRegionCodeStart, detail::kRegionCodeLength);
+        auto ymd = detail::from_day_serial(date);
+        write_digits(id.data() + detail::kDateOfBirthStart, static_cast<uint32_t>((int)ymd.year()), 4);
+        write_digits(id.data() + detail::kDateOfBirthStart + 4, (unsigned)ymd.month(), 2);
+        write_digits(id.data() + detail::kDateOfBirthStart + 6, (unsigned)ymd.day(), 2);
+        write_digits(id.data() + detail::kRegistryCodeStart, header.serial_base + serials[row], 3);
+        auto check_code = check_codes[row];
+        id[detail::kCheckCodeIndex] = check_code == 10 ? 'X' : static_cast<char>('0' + check_code);
+        callback(id);
+        ++count;
+    }
+    return count;
+}
+
+} // namespace idlib
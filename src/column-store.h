@@ -0,0 +1,156 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "details.h"
+#include "mapped-file.h"
+
+namespace idlib {
+
+//
+// Columnar id file layout (little-endian):
+// | header | block 0 | block 1 | ... | block index | footer |
+//
+// Every block holds up to block_rows ids split into four columns:
+// * region index: dictionary of the distinct region indexes in the block + bit-packed dictionary codes
+// * date of birth: day serial, bit-packed as the delta from the smallest serial in the block
+// * registry + sequence code: 3-digit number, bit-packed as the delta from the smallest one in the block
+// * check code: 4 bits
+// The block index keeps the offset, row count and region/date bounds of each block so readers can skip blocks.
+//
+
+/**
+ * @brief Selects the rows of a column_reader scan, bounds are inclusive.
+ */
+struct column_filter {
+    uint16_t region_first = 0; // index into kRegionCodes
+    uint16_t region_last = std::numeric_limits<uint16_t>::max();
+    int32_t date_first = std::numeric_limits<int32_t>::min(); // day serial
+    int32_t date_last = std::numeric_limits<int32_t>::max();
+
+    /**
+     * @brief Only keep the ids whose region code starts with a prefix, like "11" or "3205".
+     *
+     * @throw std::invalid_argument if no region code starts with the prefix.
+     */
+    column_filter &region_prefix(std::string_view prefix);
+
+    /**
+     * @brief Only keep the ids born in [first, last].
+     */
+    column_filter &date_range(std::chrono::year_month_day first, std::chrono::year_month_day last);
+};
+
+/**
+ * @brief Writes ids to a columnar file block by block.
+ */
+class column_writer {
+
+    std::ofstream out_{};
+    uint32_t block_rows_{};
+    uint64_t offset_{};
+    std::vector<uint16_t> regions_{};
+    std::vector<int32_t> dates_{};
+    std::vector<uint16_t> serials_{};
+    std::vector<uint8_t> check_codes_{};
+    std::vector<uint8_t> index_{};
+    uint32_t block_count_{};
+    bool finished_{};
+
+    void write_bytes(const void *data, size_t size);
+    void flush_block();
+
+  public:
+    /**
+     * @brief Create a columnar file.
+     *
+     * @param path The path of the file, truncated if it exists.
+     * @param block_rows The number of ids per block.
+     * @throw std::runtime_error if the file cannot be created.
+     */
+    explicit column_writer(const std::string &path, uint32_t block_rows = 4096);
+
+    column_writer(const column_writer &) = delete;
+    column_writer &operator=(const column_writer &) = delete;
+
+    /**
+     * @brief Finish the file if finish() was not called, errors are ignored.
+     */
+    ~column_writer();
+
+    /**
+     * @brief Append an id.
+     *
+     * @throw std::invalid_argument if the id is not 18 characters, or its region code or date of birth is invalid.
+     */
+    void write(std::string_view id);
+
+    /**
+     * @brief Flush the last block and write the block index.
+     *
+     * @throw std::runtime_error if writing fails.
+     */
+    void finish();
+};
+
+/**
+ * @brief Reads a columnar file through a memory mapping.
+ */
+class column_reader {
+
+  public:
+    struct block_info {
+        uint64_t offset;
+        uint32_t rows;
+        uint16_t region_first;
+        uint16_t region_last;
+        int32_t date_first;
+        int32_t date_last;
+    };
+
+  private:
+    detail::mapped_file file_;
+    std::vector<block_info> blocks_{};
+    uint64_t size_{};
+
+    uint64_t scan_block(size_t index, const column_filter &filter,
+                        const std::function<void(const id_record &)> &callback) const;
+
+  public:
+    /**
+     * @brief Open a columnar file.
+     *
+     * @throw std::runtime_error if the file cannot be mapped or is malformed.
+     */
+    explicit column_reader(const std::string &path);
+
+    /**
+     * @brief Get the number of ids in the file.
+     */
+    [[nodiscard]] uint64_t size() const noexcept;
+
+    [[nodiscard]] const std::vector<block_info> &blocks() const noexcept;
+
+    /**
+     * @brief Decode all ids of a block.
+     *
+     * @param index The index of the block.
+     * @param out The vector the ids are appended to.
+     */
+    void read_block(size_t index, std::vector<id_record> &out) const;
+
+    /**
+     * @brief Visit the ids selected by a filter, blocks whose bounds do not overlap the filter are skipped.
+     *
+     * @return uint64_t The number of ids visited.
+     */
+    uint64_t scan(const column_filter &filter, const std::function<void(const id_record &)> &callback) const;
+};
+
+} // namespace idlib
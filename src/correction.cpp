@@ -0,0 +1,144 @@
+#include "correction.h"
+#include "details.h"
+#include "mod11-2.h"
+#include "validator.h"
+
+#include <algorithm>
+#include <array>
+
+namespace idlib {
+
+namespace {
+
+constexpr int kModulus = 11;
+
+// kInverseFactors[i] * kFactors[i] == 1 (mod 11).
+constexpr std::array<int, detail::kCheckCodeIndex> kInverseFactors = [] {
+    std::array<int, detail::kCheckCodeIndex> result{};
+    for (size_t i = 0; i < result.size(); i++) {
+        for (int k = 1; k < kModulus; k++) {
+            if (mod11_2::kFactors[i] * k % kModulus == 1) {
+                result[i] = k;
+            }
+        }
+    }
+    return result;
+}();
+
+constexpr int mod(int value) { return (value % kModulus + kModulus) % kModulus; }
+
+// The value of a check code character, or -1.
+constexpr int check_value(char c) {
+    if (c == 'X' || c == 'x') {
+        return 10;
+    }
+    return c >= '0' && c <= '9' ? c - '0' : -1;
+}
+
+// The sum the first 17 digits need for the check code value cc.
+constexpr int required_sum(int cc) {
+    for (int sum = 0; sum < kModulus; sum++) {
+        if (mod11_2::kCheckInts[sum] == cc) {
+            return sum;
+        }
+    }
+    return -1;
+}
+
+// Neighbours on the number row "1234567890".
+constexpr bool adjacent_keys(char a, char b) {
+    auto key = [](char c) { return c == '0' ? 10 : c - '0'; };
+    return key(a) - key(b) == 1 || key(b) - key(a) == 1;
+}
+
+int rank(const correction &c, std::string_view original) {
+    switch (c.kind) {
+    case correction_kind::kTransposition:
+        return 0;
+    case correction_kind::kSubstitution:
+        return adjacent_keys(c.id[c.position], original[c.position]) ? 1 : 2;
+    default:
+        return 3;
+    }
+}
+
+} // namespace
+
+std::vector<correction>
+suggest_corrections(std::string_view id,
+                    const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range) {
+    std::vector<correction> result;
+    if (id.size() != 18 || validator::decode(id, valid_date_range).ok() ||
+        check_value(id[detail::kCheckCodeIndex]) < 0) {
+        return result;
+    }
+    auto add = [&](std::string candidate, correction_kind kind, size_t position) {
+        if (validator::decode(candidate, valid_date_range).ok()) {
+            result.push_back({std::move(candidate), kind, static_cast<uint8_t>(position)});
+        }
+    };
+    int cc = check_value(id[detail::kCheckCodeIndex]);
+    auto last = detail::kSequenceCodeIndex;
+
+    // An 'X' typed as the sequence code was swapped with the check code or replaced a digit.
+    if (check_value(id[last]) == 10) {
+        std::string candidate(id);
+        std::swap(candidate[last], candidate[last + 1]);
+        add(std::move(candidate), correction_kind::kTransposition, last);
+        int sum = mod11_2::weighted_sum(id.substr(0, last));
+        int replacement = mod((required_sum(cc) - sum) * kInverseFactors[last]);
+        if (replacement < 10) {
+            candidate = id;
+            candidate[last] = static_cast<char>('0' + replacement);
+            add(std::move(candidate), correction_kind::kSubstitution, last);
+        }
+        return result;
+    }
+    std::array<int, detail::kCheckCodeIndex> digits{};
+    int sum = 0;
+    for (size_t i = 0; i < detail::kCheckCodeIndex; i++) {
+        digits[i] = id[i] - '0';
+        if (digits[i] < 0 || digits[i] > 9) {
+            return result;
+        }
+        sum += digits[i] * mod11_2::kFactors[i];
+    }
+    int missing = mod(required_sum(cc) - sum);
+
+    for (size_t i = 0; i + 1 < detail::kCheckCodeIndex; i++) {
+        if (digits[i] != digits[i + 1] &&
+            mod((digits[i + 1] - digits[i]) * (mod11_2::kFactors[i] - mod11_2::kFactors[i + 1])) == missing) {
+            std::string candidate(id);
+            std::swap(candidate[i], candidate[i + 1]);
+            add(std::move(candidate), correction_kind::kTransposition, i);
+        }
+    }
+    // Swapping the sequence code with a digit check code changes both the sum and the required sum.
+    if (cc < 10 && cc != digits[last]) {
+        std::string candidate(id);
+        std::swap(candidate[last], candidate[last + 1]);
+        if (mod(sum + (cc - digits[last]) * mod11_2::kFactors[last]) == required_sum(digits[last])) {
+            add(std::move(candidate), correction_kind::kTransposition, last);
+        }
+    }
+
+    if (missing != 0) {
+        for (size_t i = 0; i < detail::kCheckCodeIndex; i++) {
+            int replacement = (digits[i] + missing * kInverseFactors[i]) % kModulus;
+            if (replacement < 10) {
+                std::string candidate(id);
+                candidate[i] = static_cast<char>('0' + replacement);
+                add(std::move(candidate), correction_kind::kSubstitution, i);
+            }
+        }
+        std::string candidate(id);
+        candidate[detail::kCheckCodeIndex] = mod11_2::kCheckDigits[mod(sum)];
+        add(std::move(candidate), correction_kind::kCheckCode, detail::kCheckCodeIndex);
+    }
+
+    std::stable_sort(result.begin(), result.end(),
+                     [&](const correction &a, const correction &b) { return rank(a, id) < rank(b, id); });
+    return result;
+}
+
+} // namespace idlib
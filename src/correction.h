@@ -0,0 +1,44 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace idlib {
+
+enum class correction_kind : uint8_t {
+    kTransposition = 0, // two adjacent characters swapped
+    kSubstitution,      // one digit of the first 17 replaced
+    kCheckCode,         // the check code replaced, always possible and therefore the least likely
+};
+
+/**
+ * @brief A valid id one typo away from the input, see suggest_corrections().
+ */
+struct correction {
+    std::string id{};
+    correction_kind kind{};
+    uint8_t position{}; // the changed position, the left one of a transposition
+};
+
+/**
+ * @brief Suggest the valid ids that are one substitution or adjacent transposition away from the input.
+ *
+ * The weighted sum of mod 11-2 is linear in every digit and the factors are invertible mod 11, so for every position
+ * the one replacement digit that restores the checksum is solved for directly instead of trying all ten, and each
+ * transposition is checked with a single multiply. The candidates are then filtered with validator::decode().
+ *
+ * Candidates are ranked by how common the typo is: transpositions, then replacements with a neighbouring key on the
+ * number row, then other replacements, then a replaced check code. Ties keep the position order.
+ *
+ * @param id The mistyped id, 18 digits with an optional 'X'/'x' check code.
+ * @param valid_date_range The valid date range of the date of birth, bounds that are not ok() are ignored.
+ * @return std::vector<correction> The ranked candidates, empty if the id is already valid or malformed.
+ */
+std::vector<correction>
+suggest_corrections(std::string_view id,
+                    const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range = {});
+
+} // namespace idlib
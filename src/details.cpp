@@ -1,5 +1,7 @@
 #include "details.h"
 
+#include <algorithm>
+
 namespace idlib::detail {
 
 std::string ymd2str(const std::chrono::year_month_day &ymd) {
@@ -22,4 +24,27 @@ std::string ymd2str(int y, int m, int d) {
     return result;
 }
 
+int region_index(std::string_view region_code) {
+    auto begin = kRegionCodes.begin();
+    auto end = kRegionCodes.begin() + kRegionCodeCount;
+    auto it = std::lower_bound(begin, end, region_code);
+    if (it == end || *it != region_code) {
+        return -1;
+    }
+    return static_cast<int>(it - begin);
+}
+
+const std::vector<uint16_t> &distinct_regions() {
+    static const std::vector<uint16_t> regions = [] {
+        std::vector<uint16_t> result;
+        for (size_t i = 0; i < kRegionCodeCount; i++) {
+            if (i == 0 || kRegionCodes[i] != kRegionCodes[i - 1]) {
+                result.push_back(static_cast<uint16_t>(i));
+            }
+        }
+        return result;
+    }();
+    return regions;
+}
+
 } // namespace idlib::detail
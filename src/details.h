@@ -1,6 +1,19 @@
 #pragma once
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "region-codes.h"
+
+namespace idlib {
+
+// An id stored as 18 bytes without terminator, arrays of records are contiguous with a stride of 18.
+using id_record = std::array<char, 18>;
+
+} // namespace idlib
 
 namespace idlib::detail {
 
@@ -16,7 +29,29 @@ constexpr size_t kRegistryCodeLength = 2;
 constexpr size_t kSequenceCodeIndex = 16;
 constexpr size_t kCheckCodeIndex = 17;
 
+// kRegionCodes is padded with empty entries at the end, the real codes are sorted and come first.
+constexpr size_t kRegionCodeCount = [] {
+    size_t count = 0;
+    while (count < kRegionCodes.size() && !kRegionCodes[count].empty()) {
+        ++count;
+    }
+    return count;
+}();
+
 std::string ymd2str(const std::chrono::year_month_day &ymd);
 std::string ymd2str(int y, int m, int d);
 
+/**
+ * @brief Find the index of a region code in kRegionCodes.
+ *
+ * @param region_code The 6-digit region code.
+ * @return int The index of the region code, or -1 if it does not exist.
+ */
+int region_index(std::string_view region_code);
+
+/**
+ * @brief The indices in kRegionCodes of the distinct region codes, kRegionCodes lists a few codes twice.
+ */
+const std::vector<uint16_t> &distinct_regions();
+
 } // namespace idlib::detail
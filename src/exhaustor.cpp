@@ -1,440 +1,380 @@
 #include "exhaustor.h"
+#include "calendar.h"
+#include "candidate-cache.h"
 #include "details.h"
 #include "mod11-2.h"
 #include "region-codes.h"
+#include "trace.h"
 
 #include <stdexcept>
 
 namespace idlib {
 
+namespace detail {
+
+struct candidate_space {
+    std::chrono::year_month_day start, end;
+    std::shared_ptr<const field_table> regions, dates, registries;
+    std::vector<char> sequences;
+    uint64_t size;
+    uint32_t fingerprint;
+};
+
+// The tables of a batch, they stay shared for the whole batch even if the global cache evicts them.
+struct field_cache {
+    std::unordered_map<candidate_cache::key, candidate_cache::value, candidate_cache::key_hash> tables;
+};
+
+} // namespace detail
+
 namespace {
 
-using namespace std::chrono;
+std::shared_ptr<const detail::field_table> make_table(std::vector<std::string> values, size_t start) {
+    auto table = std::make_shared<detail::field_table>();
+    table->sums.reserve(values.size());
+    for (auto &value : values) {
+        table->sums.push_back(mod11_2::weighted_sum(value, start));
+    }
+    table->values = std::move(values);
+    return table;
+}
 
-year get_min_matched_year(const std::string &tmpl) {
-    if (tmpl.size() != 4) {
-        throw std::invalid_argument("The length of the template must be 4.");
-    }
-    int num = 1;
-    for (int64_t i = 0; i < 4; ++i) {
-        if (tmpl[i] == '*') {
-            num *= 10;
-            continue;
-        }
-        auto add = tmpl[i] - '0';
-        if (add < 0 || add > 9) {
-            throw std::invalid_argument("The template must only contain digits and '*'.");
-        }
-        num = num * 10 + add;
+candidate_cache::key field_key(candidate_cache::field kind, const pattern &tmpl, size_t start, size_t length) {
+    candidate_cache::key key;
+    key.kind = kind;
+    for (size_t i = 0; i < length; i++) {
+        key.masks[i] = tmpl.mask(start + i);
     }
-    num %= 10000;
-    return year{num};
+    return key;
 }
 
-year get_max_matched_year(const std::string &tmpl) {
-    if (tmpl.size() != 4) {
-        throw std::invalid_argument("The length of the template must be 4.");
+// Look a table up in the batch, then in the global cache, building it with make on a miss.
+template <typename Make>
+candidate_cache::value cached(detail::field_cache *batch, const candidate_cache::key &key, Make &&make) {
+    if (!batch) {
+        return candidate_cache::global().get_or_build(key, make);
     }
-    int num = 1;
-    for (int64_t i = 0; i < 4; ++i) {
-        if (tmpl[i] == '*') {
-            num = num * 10 + 9;
-            continue;
-        }
-        auto add = tmpl[i] - '0';
-        if (add < 0 || add > 9) {
-            throw std::invalid_argument("The template must only contain digits and '*'.");
-        }
-        num = num * 10 + add;
+    auto &table = batch->tables[key];
+    if (!table) {
+        table = candidate_cache::global().get_or_build(key, make);
     }
-    num %= 10000;
-    return year{num};
+    return table;
 }
 
-bool match_year_template(year yr, const std::string &tmpl) {
-    if (tmpl.size() != 4) {
-        throw std::invalid_argument("The length of the template must be 4.");
-    }
-    auto num = (int)yr;
-    for (int64_t i = 3; i >= 0; --i) {
-        if (tmpl[i] == '*') {
-            num /= 10;
-            continue;
+// FNV-1a over the template masks and the date range, never 0 since that marks a fresh cursor.
+uint32_t fingerprint(const pattern &tmpl, std::chrono::year_month_day start, std::chrono::year_month_day end) {
+    uint32_t hash = 2166136261u;
+    auto feed = [&](uint32_t value) {
+        for (int i = 0; i < 4; i++, value >>= 8) {
+            hash = (hash ^ (value & 0xff)) * 16777619u;
         }
-        auto digit = tmpl[i] - '0';
-        if ((num % 10) != digit) {
-            return false;
-        }
-        num /= 10;
+    };
+    for (auto mask : tmpl.masks()) {
+        feed(mask);
     }
-    return true;
+    feed(static_cast<uint32_t>(detail::to_day_serial(start)));
+    feed(static_cast<uint32_t>(detail::to_day_serial(end)));
+    return hash ? hash : 1;
 }
 
-std::vector<year> range_years(year start, year end) {
-    if (start > end) {
-        throw std::invalid_argument("The start year must be earlier than the end year.");
+template <typename T> void store_le(uint8_t *out, T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+        out[i] = static_cast<uint8_t>(value >> (i * 8));
     }
-    std::vector<year> result;
-    for (auto y = start; y <= end; y += years{1}) {
-        result.push_back(y);
-    }
-    return result;
 }
 
-std::vector<year> exhaust_years(year start, year end, const std::string &tmpl) {
-    if (tmpl.size() != 4) {
-        throw std::invalid_argument("The length of the template must be 4.");
-    }
-    if (tmpl == "****") {
-        return range_years(start, end);
-    }
-    std::vector<year> result;
-    auto max_matched_year = get_max_matched_year(tmpl);
-    auto min_matched_year = get_min_matched_year(tmpl);
-    if (start < min_matched_year) {
-        start = min_matched_year;
+template <typename T> T load_le(const uint8_t *in) {
+    T value{};
+    for (size_t i = 0; i < sizeof(T); i++) {
+        value |= static_cast<T>(static_cast<T>(in[i]) << (i * 8));
     }
-    if (end > max_matched_year) {
-        end = max_matched_year;
-    }
-    for (auto y = start; y <= end; y++) {
-        if (match_year_template(y, tmpl)) {
-            result.push_back(y);
-        }
-    }
-    return result;
+    return value;
 }
 
-std::vector<month> range_months(month start, month end) {
-    if (start > end) {
-        throw std::invalid_argument("The start month must be earlier than the end month.");
-    }
-    std::vector<month> result;
-    for (auto m = start; m <= end; m += months{1}) {
-        result.push_back(m);
-        if (m == month{12}) {
-            break;
-        }
-    }
-    return result;
+constexpr uint8_t kCursorVersion = 1;
+
+} // namespace
+
+std::array<uint8_t, exhaust_cursor::kSerializedSize> exhaust_cursor::serialize() const noexcept {
+    std::array<uint8_t, kSerializedSize> data{};
+    data[0] = kCursorVersion;
+    data[1] = registry;
+    data[2] = sequence;
+    store_le(data.data() + 4, region);
+    store_le(data.data() + 8, date);
+    store_le(data.data() + 12, fingerprint);
+    return data;
 }
 
-std::vector<month> exhaust_months(month start, month end, const std::string &tmpl) {
-    if (tmpl.size() != 2) {
-        throw std::invalid_argument("The length of the template must be 2.");
-    }
-    if (tmpl == "**") {
-        return range_months(start, end);
-    }
-    if (tmpl[0] == '*') {
-        uint32_t m = tmpl[1] - '0';
-        if (m > 2) {
-            // tmpl[0] = '0'
-            if (start < month{m} && end > month{m}) {
-                return {month{m}};
-            }
-            return {};
-        } else {
-            // tmpl[0] = '1' or '0'
-            std::vector<month> result;
-            if (start <= month{m} && end >= month{m}) {
-                result.emplace_back(m);
-            }
-            if (start <= month{m + 10} && end >= month{m + 10}) {
-                result.emplace_back(m + 10);
-            }
-            return result;
-        }
-    } else if (tmpl[1] == '*') {
-        uint32_t m = tmpl[0] - '0';
-        if (m == 0) {
-            // tmpl[1] = '0'~'9'
-            if (start < month{10}) {
-                return range_months(start, end >= month(10) ? month(9) : end);
-            }
-            return {};
-        } else if (m == 1) {
-            // tmpl[1] = '0'~'2'
-            if (end >= month{10}) {
-                return range_months(start >= month(10) ? start : month(10), end);
-            }
-            return {};
-        }
-        return {};
-    } else {
-        uint32_t m = (tmpl[0] - '0') * 10 + (tmpl[1] - '0');
-        if (m > 12) {
-            return {};
-        }
-        if (start < month{m} && end > month{m}) {
-            return {month{m}};
-        }
-        return {};
-    }
+exhaust_cursor exhaust_cursor::deserialize(std::span<const uint8_t> data) {
+    if (data.size() != kSerializedSize || data[0] != kCursorVersion) {
+        throw std::invalid_argument("The data is not a serialized cursor.");
+    }
+    exhaust_cursor cursor;
+    cursor.registry = data[1];
+    cursor.sequence = data[2];
+    cursor.region = load_le<uint16_t>(data.data() + 4);
+    cursor.date = load_le<uint32_t>(data.data() + 8);
+    cursor.fingerprint = load_le<uint32_t>(data.data() + 12);
+    return cursor;
 }
 
-std::vector<year_month> range_year_months(year_month start, year_month end) {
-    if (start > end) {
-        throw std::invalid_argument("The start year_month must be earlier than the end year_month.");
-    }
-    std::vector<year_month> result;
-    for (auto ym = start; ym <= end; ym += months{1}) {
-        result.push_back(ym);
-    }
-    return result;
+exhaustor::exhaustor(const std::string &id) : pattern_(id) {}
+
+exhaustor::exhaustor(const pattern &tmpl) noexcept : pattern_(tmpl) {}
+
+const pattern &exhaustor::tmpl() const noexcept { return pattern_; }
+
+std::chrono::year_month_day exhaustor::today() {
+    return std::chrono::year_month_day{std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now())};
 }
 
-std::vector<year_month> exhaust_year_months(year_month start, year_month end, const std::string &tmpl) {
-    if (tmpl.size() != 6) {
-        throw std::invalid_argument("The length of the template must be 6.");
-    }
-    if (tmpl == "******") {
-        return range_year_months(start, end);
-    }
-    auto year_tmpl = tmpl.substr(0, 4);
-    auto month_tmpl = tmpl.substr(4, 2);
-    auto years = exhaust_years(start.year(), end.year(), year_tmpl);
-    std::vector<year_month> result;
-    for (auto y : years) {
-        auto start_month = y == start.year() ? start.month() : std::chrono::month{1};
-        auto end_month = y == end.year() ? end.month() : std::chrono::month{12};
-        auto months = exhaust_months(start_month, end_month, month_tmpl);
-        for (auto m : months) {
-            result.emplace_back(y, m);
-        }
+const detail::candidate_space &exhaustor::space(std::chrono::year_month_day start, std::chrono::year_month_day end) {
+    if (!space_ || space_->start != start || space_->end != end) {
+        space_ = make_space(start, end, nullptr);
     }
-    return result;
+    return *space_;
 }
 
-std::vector<day> range_days(day start, day end) {
+std::shared_ptr<const detail::candidate_space>
+exhaustor::make_space(std::chrono::year_month_day start, std::chrono::year_month_day end, detail::field_cache *cache) {
     if (start > end) {
-        throw std::invalid_argument("The start day must be earlier than the end day.");
-    }
-    std::vector<day> result;
-    for (auto d = start; d <= end; d += days{1}) {
-        result.push_back(d);
+        throw std::invalid_argument("The start date must be earlier than the end date.");
     }
-    return result;
+    auto space = std::make_shared<detail::candidate_space>();
+    space->start = start;
+    space->end = end;
+    using field = candidate_cache::field;
+    auto region_key = field_key(field::kRegionCode, pattern_, detail::kRegionCodeStart, detail::kRegionCodeLength);
+    space->regions = cached(cache, region_key, [&] {
+        IDLIB_TRACE_SCOPE("exhaustor.region_codes");
+        return make_table(exhaust_region_code(), detail::kRegionCodeStart);
+    });
+    auto date_key = field_key(field::kDateOfBirth, pattern_, detail::kDateOfBirthStart, detail::kDateOfBirthLength);
+    date_key.date_start = detail::to_day_serial(start);
+    date_key.date_end = detail::to_day_serial(end);
+    space->dates = cached(cache, date_key, [&] {
+        IDLIB_TRACE_SCOPE("exhaustor.dates");
+        return make_table(exhaust_date_of_birth(start, end), detail::kDateOfBirthStart);
+    });
+    auto registry_key =
+        field_key(field::kRegistryCode, pattern_, detail::kRegistryCodeStart, detail::kRegistryCodeLength);
+    space->registries = cached(cache, registry_key, [&] {
+        IDLIB_TRACE_SCOPE("exhaustor.registry_codes");
+        return make_table(exhaust_registry_code(), detail::kRegistryCodeStart);
+    });
+    space->sequences = exhaust_sequence_code();
+    space->size = static_cast<uint64_t>(space->regions->values.size()) * space->dates->values.size() *
+                  space->registries->values.size() * space->sequences.size();
+    space->fingerprint = fingerprint(pattern_, start, end);
+    return space;
 }
 
-std::vector<day> exhaust_days(day start, day end, const std::string &tmpl) {
-    if (tmpl.size() != 2) {
-        throw std::invalid_argument("The length of the template must be 2.");
-    }
-    if (tmpl == "**") {
-        return range_days(start, end);
-    }
-    if (tmpl[0] == '*') {
-        std::vector<day> result;
-        uint32_t d = tmpl[1] - '0';
-        for (int i = 0; i <= 3; i++) {
-            uint32_t num = d + i * 10;
-            if (start <= day{num} && end >= day{num}) {
-                result.emplace_back(num);
-            }
-        }
-        return result;
-    } else if (tmpl[1] == '*') {
-        switch (tmpl[0] - '0') {
-        case 0:
-            if (start < day{10}) {
-                return range_days(start, end >= day(10) ? day(9) : end);
-            }
-            return {};
-        case 1:
-            if (start < day{20} && end > day{10}) {
-                return range_days(start < day{10} ? day{10} : start, end >= day{20} ? day{19} : end);
-            }
-            return {};
-        case 2:
-            if (start < day{30} && end > day{20}) {
-                return range_days(start < day{20} ? day{20} : start, end >= day{30} ? day{29} : end);
-            }
-            return {};
-        case 3:
-            if (start < day{31} && end >= day{30}) {
-                return range_days(start < day{30} ? day{30} : start, end);
-            }
-            return {};
-        default:
-            return {};
-        }
-    } else {
-        uint32_t d = (tmpl[0] - '0') * 10 + (tmpl[1] - '0');
-        if (start <= day{d} && end >= day{d}) {
-            return {day{d}};
+std::vector<std::string> exhaustor::exhaust_region_code() {
+    std::vector<std::string> result;
+    for (size_t index = 0; index < detail::kRegionCodeCount; index++) {
+        auto region = kRegionCodes[index];
+        if (pattern_.match(region, detail::kRegionCodeStart)) {
+            result.emplace_back(region);
         }
-        return {};
     }
+    return result;
 }
 
-std::vector<year_month_day> exhaust_year_month_days(year_month_day start, year_month_day end, const std::string &tmpl) {
-    if (tmpl.size() != 8) {
-        throw std::invalid_argument("The length of the template must be 8.");
+std::vector<std::string> exhaustor::exhaust_date_of_birth(std::chrono::year_month_day start,
+                                                          std::chrono::year_month_day end) {
+    if (start > end) {
+        throw std::invalid_argument("The start date must be earlier than the end date.");
     }
-    auto year_tmpl = tmpl.substr(0, 4);
-    auto month_tmpl = tmpl.substr(4, 2);
-    auto day_tmpl = tmpl.substr(6, 2);
-    auto start_ym = year_month{start.year(), start.month()};
-    auto end_ym = year_month{end.year(), end.month()};
-    auto year_months = exhaust_year_months(start_ym, end_ym, year_tmpl + month_tmpl);
-    std::vector<year_month_day> result;
-    for (auto &ym : year_months) {
-        auto start_day = ym == start_ym ? start.day() : std::chrono::day{1};
-        auto end_day = ym == end_ym ? end.day() : year_month_day_last(ym.year(), month_day_last(ym.month())).day();
-        auto days = exhaust_days(start_day, end_day, day_tmpl);
-        for (auto d : days) {
-            result.emplace_back(ym.year(), ym.month(), d);
-        }
+    std::vector<std::string> result;
+    detail::date_enumerator dates(pattern_.date_masks(), start, end);
+    char buf[detail::kDateOfBirthLength];
+    while (dates.next(buf)) {
+        result.emplace_back(buf, detail::kDateOfBirthLength);
     }
     return result;
 }
 
-std::vector<std::string> combine_vector(const std::vector<std::string> &v1, const std::vector<std::string> &v2) {
+std::vector<std::string> exhaustor::exhaust_registry_code() {
     std::vector<std::string> result;
-    for (auto &s1 : v1) {
-        for (auto &s2 : v2) {
-            result.emplace_back(s1 + s2);
+    char first[10];
+    char second[10];
+    auto first_count = pattern_.digits(detail::kRegistryCodeStart, first);
+    auto second_count = pattern_.digits(detail::kRegistryCodeStart + 1, second);
+    for (size_t i = 0; i < first_count; i++) {
+        for (size_t j = 0; j < second_count; j++) {
+            auto &str = result.emplace_back();
+            str.push_back(first[i]);
+            str.push_back(second[j]);
         }
     }
     return result;
 }
 
-std::vector<std::string> combine_vector(const std::vector<std::string> &v1, const std::vector<char> &v2) {
+std::vector<char> exhaustor::exhaust_sequence_code() {
+    char digits[10];
+    auto count = pattern_.digits(detail::kSequenceCodeIndex, digits);
+    return {digits, digits + count};
+}
+
+std::vector<std::string> exhaustor::exhaust_all(std::chrono::year_month_day start, std::chrono::year_month_day end) {
+    IDLIB_TRACE_SCOPE("exhaustor.exhaust_all");
+    const auto &sp = space(start, end);
     std::vector<std::string> result;
-    for (auto &s1 : v1) {
-        for (auto &s2 : v2) {
-            result.emplace_back(s1 + s2);
-        }
-    }
+    IDLIB_TRACE_SCOPE("exhaustor.combine");
+    exhaust_slice(sp, 0, sp.size, SIZE_MAX, [&](std::string_view id) { result.emplace_back(id); });
     return result;
 }
 
-template <typename ... Args>
-std::vector<std::string> combine_vector(const std::vector<std::string> &v1, const std::vector<std::string> &v2,
-                                        const Args &... args) {
-    return combine_vector(combine_vector(v1, v2), args...);
+uint64_t exhaustor::size(std::chrono::year_month_day start, std::chrono::year_month_day end) {
+    return space(start, end).size;
 }
 
-} // namespace
-
-exhaustor::exhaustor(const std::string &id) {
-    if (id.size() != 18) {
-        throw std::invalid_argument("The length of the id must be 18.");
+std::optional<std::string> exhaustor::nth(uint64_t i, std::chrono::year_month_day start,
+                                          std::chrono::year_month_day end) {
+    auto result = range(i, i + 1, start, end);
+    if (result.empty()) {
+        return std::nullopt;
     }
-    for (size_t i = 0; i < 18; i++) {
-        if (i == detail::kSequenceCodeIndex && id[i] != '*' && id[i] != 'm' && id[i] != 'M' && id[i] != 'f' &&
-            id[i] != 'F' && (id[i] < '0' || id[i] > '9')) {
-            throw std::invalid_argument("The sequence code must be a digit, 'm'/'M', 'f'/'F' or '*'.");
-        } else if (i == detail::kCheckCodeIndex && id[i] != '*' && id[i] != 'X' && id[i] != 'x' &&
-                   (id[i] < '0' || id[i] > '9')) {
-            throw std::invalid_argument("The check code must be a digit or 'X'/'x' or '*'.");
-        } else if (id[i] != '*' && (id[i] < '0' || id[i] > '9')) {
-            throw std::invalid_argument("The id must only contain digits and '*'.");
-        }
-    }
-
-    id_ = id;
+    return std::move(result.front());
 }
 
-std::vector<std::string> exhaustor::exhaust_region_code() {
-    std::vector<std::string> result;
-    for (auto &region : kRegionCodes) {
-        bool matched = true;
-        for (size_t i = detail::kRegionCodeStart; i < detail::kRegionCodeEnd; i++) {
-            if (id_[i] != '*' && region[i] != id_[i]) {
-                matched = false;
-                break;
-            }
-        }
-        if (matched) {
-            result.emplace_back(region);
-        }
+std::vector<std::string> exhaustor::range(uint64_t begin, uint64_t end, std::chrono::year_month_day start_date,
+                                          std::chrono::year_month_day end_date) {
+    const auto &sp = space(start_date, end_date);
+    if (begin > end || end > sp.size) {
+        throw std::out_of_range("The range is out of the combinations.");
     }
+    std::vector<std::string> result;
+    exhaust_slice(sp, begin, end, SIZE_MAX, [&](std::string_view id) { result.emplace_back(id); });
     return result;
 }
 
-std::vector<std::string> exhaustor::exhaust_date_of_birth(std::chrono::year_month_day start,
-                                                          std::chrono::year_month_day end) {
-    if (start > end) {
-        throw std::invalid_argument("The start date must be earlier than the end date.");
+std::vector<std::string> exhaustor::exhaust(exhaust_cursor &cursor, size_t max_ids, std::chrono::year_month_day start,
+                                            std::chrono::year_month_day end) {
+    const auto &sp = space(start, end);
+    if (cursor == exhaust_cursor{}) {
+        cursor.fingerprint = sp.fingerprint;
+    }
+    if (cursor.fingerprint != sp.fingerprint) {
+        throw std::invalid_argument("The cursor belongs to another template or date range.");
     }
-    auto tmpl = id_.substr(detail::kDateOfBirthStart, detail::kDateOfBirthLength);
     std::vector<std::string> result;
-    auto ymds = exhaust_year_month_days(start, end, tmpl);
-    for (auto &ymd : ymds) {
-        result.emplace_back(detail::ymd2str(ymd));
+    uint64_t dates = sp.dates->values.size();
+    uint64_t registries = sp.registries->values.size();
+    uint64_t sequences = sp.sequences.size();
+    if (sp.size == 0 || cursor.region >= sp.regions->values.size()) {
+        return result;
     }
+    if (cursor.date >= dates || cursor.registry >= registries || cursor.sequence >= sequences) {
+        throw std::invalid_argument("The cursor is out of the combinations.");
+    }
+    uint64_t begin =
+        ((cursor.region * dates + cursor.date) * registries + cursor.registry) * sequences + cursor.sequence;
+    uint64_t next = exhaust_slice(sp, begin, sp.size, max_ids, [&](std::string_view id) { result.emplace_back(id); });
+    cursor.sequence = static_cast<uint8_t>(next % sequences);
+    next /= sequences;
+    cursor.registry = static_cast<uint8_t>(next % registries);
+    next /= registries;
+    cursor.date = static_cast<uint32_t>(next % dates);
+    cursor.region = static_cast<uint16_t>(next / dates);
     return result;
 }
 
-std::vector<std::string> exhaustor::exhaust_registry_code() {
-    std::vector<std::string> result;
-    auto registry_code = id_.substr(detail::kRegistryCodeStart, detail::kRegistryCodeLength);
-    if (registry_code[0] == '*' && registry_code[1] == '*') {
-        // 00 - 99
-        for (char i = 0; i < 100; i++) {
-            auto &str = result.emplace_back();
-            str.push_back(static_cast<char>(i / 10 + '0'));
-            str.push_back(static_cast<char>(i % 10 + '0'));
-        }
-    } else if (registry_code[0] == '*') {
-        // *0 - *9
-        for (char i = 0; i < 10; i++) {
-            auto &str = result.emplace_back();
-            str.push_back(static_cast<char>(i + '0'));
-            str.push_back(registry_code[1]);
+std::optional<std::string> exhaustor::try_sample(uint64_t r, std::chrono::year_month_day start,
+                                                 std::chrono::year_month_day end) {
+    const auto &sp = space(start, end);
+    const auto &dates = *sp.dates;
+    const auto &registries = *sp.registries;
+    auto pick = r % sp.sequences.size();
+    auto rest = r / sp.sequences.size();
+    auto registry = rest % registries.values.size();
+    rest /= registries.values.size();
+    auto date = rest % dates.values.size();
+    auto region = rest / dates.values.size();
+
+    auto prefix_sum = sp.regions->sums[region] + dates.sums[date] + registries.sums[registry];
+    for (auto sequence : sp.sequences) {
+        auto sum = prefix_sum + (sequence - '0') * mod11_2::kFactors[detail::kSequenceCodeIndex];
+        auto cc = mod11_2::kCheckDigits[sum % 11];
+        if (!pattern_.allows(detail::kCheckCodeIndex, cc)) {
+            continue;
         }
-    } else if (registry_code[1] == '*') {
-        // 0* - 9*
-        for (char i = 0; i < 10; i++) {
-            auto &str = result.emplace_back();
-            str.push_back(registry_code[0]);
-            str.push_back(static_cast<char>(i + '0'));
+        if (pick > 0) {
+            --pick;
+            continue;
         }
-    } else {
-        result.emplace_back(registry_code);
-    }
-    return result;
+        std::string id(18, '\0');
+        sp.regions->values[region].copy(id.data() + detail::kRegionCodeStart, detail::kRegionCodeLength);
+        dates.values[date].copy(id.data() + detail::kDateOfBirthStart, detail::kDateOfBirthLength);
+        registries.values[registry].copy(id.data() + detail::kRegistryCodeStart, detail::kRegistryCodeLength);
+        id[detail::kSequenceCodeIndex] = sequence;
+        id[detail::kCheckCodeIndex] = cc;
+        return id;
+    }
+    return std::nullopt;
 }
 
-std::vector<char> exhaustor::exhaust_sequence_code() {
-    char seq = id_[detail::kSequenceCodeIndex];
-    switch (seq) {
-    case '*':
-        return {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
-    case 'm':
-    case 'M':
-        return {'1', '3', '5', '7', '9'};
-    case 'f':
-    case 'F':
-        return {'0', '2', '4', '6', '8'};
-    default:
-        return {seq};
+void exhaustor::exhaust_batch(std::span<const pattern> templates,
+                              const std::function<void(size_t, std::string_view)> &on_id,
+                              std::chrono::year_month_day start, std::chrono::year_month_day end) {
+    detail::field_cache cache;
+    for (size_t i = 0; i < templates.size(); i++) {
+        exhaustor ex(templates[i]);
+        auto sp = ex.make_space(start, end, &cache);
+        ex.exhaust_slice(*sp, 0, sp->size, SIZE_MAX, [&](std::string_view id) { on_id(i, id); });
     }
 }
 
-std::vector<std::string> exhaustor::exhaust_all(std::chrono::year_month_day start, std::chrono::year_month_day end) {
-    auto region_codes = exhaust_region_code();
-    auto date_of_births = exhaust_date_of_birth(start, end);
-    auto registry_codes = exhaust_registry_code();
-    auto sequence_codes = exhaust_sequence_code();
-    std::vector<std::string> result;
-    char check_code = id_[detail::kCheckCodeIndex];
-    if (check_code == '*') {
-        result = combine_vector(region_codes, date_of_births, registry_codes, sequence_codes);
-        for (auto &id : result) {
-            id += mod11_2::do_mod11_2(id);
+template <typename Sink>
+uint64_t exhaustor::exhaust_slice(const detail::candidate_space &sp, uint64_t begin, uint64_t end, size_t max_ids,
+                                  Sink &&sink) const {
+    if (begin == end || max_ids == 0) {
+        return begin;
+    }
+    const auto &regions = *sp.regions;
+    const auto &dates = *sp.dates;
+    const auto &registries = *sp.registries;
+    const auto &sequences = sp.sequences;
+
+    // Unrank begin into mixed-radix digits, the sequence code is the least significant one.
+    uint64_t rest = begin;
+    size_t sequence = rest % sequences.size();
+    rest /= sequences.size();
+    size_t registry = rest % registries.values.size();
+    rest /= registries.values.size();
+    size_t date = rest % dates.values.size();
+    size_t region = rest / dates.values.size();
+
+    size_t appended = 0;
+    char id[18];
+    uint64_t i = begin;
+    while (i < end && appended < max_ids) {
+        auto sum = regions.sums[region] + dates.sums[date] + registries.sums[registry] +
+                   (sequences[sequence] - '0') * mod11_2::kFactors[detail::kSequenceCodeIndex];
+        auto cc = mod11_2::kCheckDigits[sum % 11];
+        if (pattern_.allows(detail::kCheckCodeIndex, cc)) {
+            regions.values[region].copy(id + detail::kRegionCodeStart, detail::kRegionCodeLength);
+            dates.values[date].copy(id + detail::kDateOfBirthStart, detail::kDateOfBirthLength);
+            registries.values[registry].copy(id + detail::kRegistryCodeStart, detail::kRegistryCodeLength);
+            id[detail::kSequenceCodeIndex] = sequences[sequence];
+            id[detail::kCheckCodeIndex] = cc;
+            sink(std::string_view(id, sizeof(id)));
+            ++appended;
         }
-    } else {
-        auto combined = combine_vector(region_codes, date_of_births, registry_codes, sequence_codes);
-        for (auto &id : combined) {
-            if (mod11_2::do_mod11_2(id) == check_code) {
-                result.emplace_back(id + check_code);
+        ++i;
+        if (++sequence == sequences.size()) {
+            sequence = 0;
+            if (++registry == registries.values.size()) {
+                registry = 0;
+                if (++date == dates.values.size()) {
+                    date = 0;
+                    ++region;
+                }
             }
         }
     }
-    return result;
+    return i;
 }
 
-} // namespace idlib
\ No newline at end of file
+} // namespace idlib
@@ -1,9 +1,18 @@
 #pragma once
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "pattern.h"
+
 //
 // Basic PRC ID format:
 // | INDEX | 00 01 | 02 03 | 04 05 | 06 07 08 09 | 10 11 | 12 13 | 14 15 | 16 | 17 |
@@ -16,22 +25,94 @@
 
 namespace idlib {
 
+namespace detail {
+struct candidate_space;
+struct field_cache;
+} // namespace detail
+
+/**
+ * @brief The position of a resumable exhaustion, see exhaustor::exhaust.
+ *
+ * The position is stored as the index of each field in its candidate list, plus a fingerprint of the template and
+ * date range so a checkpoint can't be resumed against a different search. A default constructed cursor starts at the
+ * beginning of any search.
+ */
+struct exhaust_cursor {
+    static constexpr size_t kSerializedSize = 16;
+
+    uint32_t fingerprint{};
+    uint32_t date{};
+    uint16_t region{};
+    uint8_t registry{};
+    uint8_t sequence{};
+
+    /**
+     * @brief Serialize the cursor into a fixed size little-endian record.
+     */
+    [[nodiscard]] std::array<uint8_t, kSerializedSize> serialize() const noexcept;
+
+    /**
+     * @brief Deserialize a cursor written by serialize.
+     *
+     * @throw std::invalid_argument if the data is not a serialized cursor.
+     */
+    static exhaust_cursor deserialize(std::span<const uint8_t> data);
+
+    constexpr bool operator==(const exhaust_cursor &) const noexcept = default;
+};
+
 class exhaustor {
 
-    std::string id_{};
+    pattern pattern_;
+    std::shared_ptr<const detail::candidate_space> space_;
+
+    const detail::candidate_space &space(std::chrono::year_month_day start, std::chrono::year_month_day end);
+
+    // Build the candidate tables, taking the ones of fields with the same masks from the cache if there is one.
+    std::shared_ptr<const detail::candidate_space>
+    make_space(std::chrono::year_month_day start, std::chrono::year_month_day end, detail::field_cache *cache);
+
+    // Map r in [0, size) to an id: r / |sequences| picks the other fields and r % |sequences| picks one of the
+    // sequence codes that give an allowed check code, nothing if there are fewer than that.
+    std::optional<std::string> try_sample(uint64_t r, std::chrono::year_month_day start,
+                                          std::chrono::year_month_day end);
+
+    // Pass the accepted ids with an index in [begin, end) to sink until max_ids were passed, return where it stopped.
+    template <typename Sink>
+    uint64_t exhaust_slice(const detail::candidate_space &sp, uint64_t begin, uint64_t end, size_t max_ids,
+                           Sink &&sink) const;
 
   public:
+    static constexpr std::chrono::year_month_day kDefaultStart{std::chrono::year(1920), std::chrono::month(1),
+                                                               std::chrono::day(1)};
+
+    /**
+     * @brief Get the default end date, today in UTC.
+     */
+    static std::chrono::year_month_day today();
+
     /**
      * @brief Construct a new exhaustor object.
      *
-     * @param id The known part of the id, like "11****19190810***0" or "11****19190810**m0"(m=male, f=female).
-     * @throw std::invalid_argument if the length of the id is not 18.
+     * @param id The known part of the id, like "11****19190810***0", "11****19190810**m0"(m=male, f=female) or
+     * "11****19[0-3]*0810***0", see pattern for the full syntax.
+     * @throw std::invalid_argument if the id does not have 18 positions.
      * @throw std::invalid_argument if the id contains invalid characters.
-     * @throw std::invalid_argument if the region code is invalid.
+     * @throw std::invalid_argument if the sequence code is invalid.
      * @throw std::invalid_argument if the check code is invalid.
      */
     explicit exhaustor(const std::string &id);
 
+    /**
+     * @brief Construct a new exhaustor object from a compiled template.
+     */
+    explicit exhaustor(const pattern &tmpl) noexcept;
+
+    /**
+     * @brief Get the compiled template.
+     */
+    [[nodiscard]] const pattern &tmpl() const noexcept;
+
     /**
      * @brief Exhaust the region code.
      *
@@ -68,9 +149,100 @@ class exhaustor {
      *
      * @return std::vector<std::string> The possible ids.
      */
-    std::vector<std::string> exhaust_all(
-        std::chrono::year_month_day start = {std::chrono::year(1920), std::chrono::month(1), std::chrono::day(1)},
-        std::chrono::year_month_day end = std::chrono::year_month_day{std::chrono::local_days(
-            std::chrono::duration_cast<std::chrono::days>(std::chrono::system_clock::now().time_since_epoch()))});
+    std::vector<std::string> exhaust_all(std::chrono::year_month_day start = kDefaultStart,
+                                         std::chrono::year_month_day end = today());
+
+    /**
+     * @brief Get the number of combinations of the field candidates, including the ones whose check code the
+     * template rejects.
+     *
+     * Combinations are ordered like exhaust_all: by region code, then date of birth, registry code and sequence code.
+     * The candidate lists are built once per date range and shared by size, nth and range.
+     *
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    uint64_t size(std::chrono::year_month_day start = kDefaultStart, std::chrono::year_month_day end = today());
+
+    /**
+     * @brief Get the i-th combination.
+     *
+     * @return std::optional<std::string> The id, or nothing if the template rejects its check code.
+     * @throw std::out_of_range if i is not less than size(start, end).
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    std::optional<std::string> nth(uint64_t i, std::chrono::year_month_day start = kDefaultStart,
+                                   std::chrono::year_month_day end = today());
+
+    /**
+     * @brief Exhaust the combinations in [begin, end), concatenating the ranges of a partition of [0, size()) gives
+     * exhaust_all.
+     *
+     * @return std::vector<std::string> The possible ids in the slice.
+     * @throw std::out_of_range if begin > end or end > size(start_date, end_date).
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    std::vector<std::string> range(uint64_t begin, uint64_t end, std::chrono::year_month_day start_date = kDefaultStart,
+                                   std::chrono::year_month_day end_date = today());
+
+    /**
+     * @brief Exhaust up to max_ids ids from the cursor and advance it past them.
+     *
+     * Calling this until it returns an empty vector yields exactly exhaust_all, the cursor can be serialized between
+     * calls and the job resumed in another process.
+     *
+     * @return std::vector<std::string> The next ids, empty once the search is finished.
+     * @throw std::invalid_argument if the cursor belongs to another template or date range.
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    std::vector<std::string> exhaust(exhaust_cursor &cursor, size_t max_ids,
+                                     std::chrono::year_month_day start = kDefaultStart,
+                                     std::chrono::year_month_day end = today());
+
+    /**
+     * @brief Draw an id uniformly from the ids of the template without enumerating them.
+     *
+     * Every field is drawn from its candidate table and the sequence code is drawn among the ones whose check code
+     * the template allows, a draw is only repeated when no sequence code fits. A template whose ids are too rare
+     * for that to succeed is exhausted instead.
+     *
+     * @throw std::invalid_argument if no id matches the template.
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    template <typename Random>
+    std::string sample(Random &random, std::chrono::year_month_day start = kDefaultStart,
+                       std::chrono::year_month_day end = today()) {
+        constexpr int kAttempts = 256;
+        auto n = size(start, end);
+        if (n == 0) {
+            throw std::invalid_argument("No id matches the template.");
+        }
+        std::uniform_int_distribution<uint64_t> dist(0, n - 1);
+        for (int attempt = 0; attempt < kAttempts; attempt++) {
+            if (auto id = try_sample(dist(random), start, end)) {
+                return std::move(*id);
+            }
+        }
+        auto ids = exhaust_all(start, end);
+        if (ids.empty()) {
+            throw std::invalid_argument("No id matches the template.");
+        }
+        return std::move(ids[std::uniform_int_distribution<size_t>(0, ids.size() - 1)(random)]);
+    }
+
+    /**
+     * @brief Exhaust many templates, building the candidate table of each distinct field once.
+     *
+     * Templates with the same masks for the region code, date of birth or registry code share the table of that
+     * field, so a job with many masked variants of a few fields doesn't redo the region or date enumeration.
+     *
+     * @param templates The compiled templates.
+     * @param on_id Called with the index of the template and each of its ids, template by template in the order of
+     * exhaust_all, nothing is materialized.
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    static void exhaust_batch(std::span<const pattern> templates,
+                              const std::function<void(size_t, std::string_view)> &on_id,
+                              std::chrono::year_month_day start = kDefaultStart,
+                              std::chrono::year_month_day end = today());
 };
 } // namespace idlib
\ No newline at end of file
@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+namespace idlib::detail {
+
+/**
+ * @brief SipHash-2-4 of a message of 64-bit words, read as little-endian bytes.
+ */
+template <size_t N>
+[[nodiscard]] constexpr uint64_t siphash24(uint64_t k0, uint64_t k1, const std::array<uint64_t, N> &words) noexcept {
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL, v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL, v3 = k1 ^ 0x7465646279746573ULL;
+    auto round = [&] {
+        v0 += v1, v1 = std::rotl(v1, 13), v1 ^= v0, v0 = std::rotl(v0, 32);
+        v2 += v3, v3 = std::rotl(v3, 16), v3 ^= v2;
+        v0 += v3, v3 = std::rotl(v3, 21), v3 ^= v0;
+        v2 += v1, v1 = std::rotl(v1, 17), v1 ^= v2, v2 = std::rotl(v2, 32);
+    };
+    auto compress = [&](uint64_t m) {
+        v3 ^= m;
+        round();
+        round();
+        v0 ^= m;
+    };
+    for (auto word : words) {
+        compress(word);
+    }
+    compress(uint64_t{N * 8 % 256} << 56);
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; i++) {
+        round();
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * @brief A fast round function, a multiply-xorshift mixer under round keys expanded from a 64-bit key.
+ *
+ * It only has to look random, it is not a pseudorandom function against an adversary.
+ */
+class mix_round {
+
+    std::array<uint64_t, 8> keys_{};
+
+    static constexpr uint64_t splitmix(uint64_t &state) noexcept {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+  public:
+    static constexpr int kRounds = 8;
+
+    constexpr mix_round() = default;
+
+    constexpr mix_round(uint64_t key) noexcept {
+        for (auto &k : keys_) {
+            k = splitmix(key);
+        }
+    }
+
+    [[nodiscard]] constexpr uint64_t operator()(int i, uint64_t, uint64_t half) const noexcept {
+        uint64_t z = (half ^ keys_[i]) * 0xff51afd7ed558ccdULL;
+        z ^= z >> 33;
+        z *= 0xc4ceb9fe1a85ec53ULL;
+        z ^= z >> 33;
+        return z;
+    }
+};
+
+/**
+ * @brief A keyed pseudorandom round function, SipHash-2-4 under a 128-bit key of the domain, the round and the half.
+ *
+ * Like FF1 the domain is part of every round input and 10 rounds are used.
+ */
+class siphash_round {
+
+    uint64_t k0_{};
+    uint64_t k1_{};
+
+  public:
+    static constexpr int kRounds = 10;
+
+    constexpr siphash_round() = default;
+
+    constexpr siphash_round(const std::array<uint8_t, 16> &key) noexcept {
+        for (int i = 7; i >= 0; i--) {
+            k0_ = k0_ << 8 | key[i];
+            k1_ = k1_ << 8 | key[i + 8];
+        }
+    }
+
+    [[nodiscard]] constexpr uint64_t operator()(int i, uint64_t domain, uint64_t half) const noexcept {
+        return siphash24(k0_, k1_, std::array<uint64_t, 2>{domain, static_cast<uint64_t>(i) << 56 | half});
+    }
+};
+
+/**
+ * @brief A keyed bijection over [0, domain) built from an unbalanced Feistel network and cycle walking.
+ *
+ * The network permutes the smallest bit width that covers the domain, split into halves that differ by at most one
+ * bit, outputs that fall outside of the domain are fed back in until they land inside it. Since the width is less
+ * than twice the domain (for domains above 2), a walk takes fewer than 2 steps on average. How hard the permutation is
+ * to predict or invert without the key is up to the Round function.
+ */
+template <typename Round> class basic_feistel_permutation {
+
+    static constexpr int kRounds = Round::kRounds;
+
+    uint64_t domain_{};
+    int left_bits_{};  // the high half, right_bits_ or one bit less
+    int right_bits_{}; // the low half
+    Round round_{};
+
+    /// The round function, truncated to the given bit count.
+    [[nodiscard]] constexpr uint64_t round(int i, uint64_t half, int bits) const noexcept {
+        return round_(i, domain_, half) & ((1ULL << bits) - 1);
+    }
+
+    // The halves swap widths every round, kRounds is even so they end up where they started.
+    static_assert(kRounds % 2 == 0);
+
+    [[nodiscard]] constexpr uint64_t encrypt(uint64_t x) const noexcept {
+        uint64_t left = x >> right_bits_, right = x & ((1ULL << right_bits_) - 1);
+        for (int i = 0; i < kRounds; i++) {
+            uint64_t next = left ^ round(i, right, i % 2 == 0 ? left_bits_ : right_bits_);
+            left = right;
+            right = next;
+        }
+        return left << right_bits_ | right;
+    }
+
+    [[nodiscard]] constexpr uint64_t decrypt(uint64_t x) const noexcept {
+        uint64_t left = x >> right_bits_, right = x & ((1ULL << right_bits_) - 1);
+        for (int i = kRounds - 1; i >= 0; i--) {
+            uint64_t prev = right ^ round(i, left, i % 2 == 0 ? left_bits_ : right_bits_);
+            right = left;
+            left = prev;
+        }
+        return left << right_bits_ | right;
+    }
+
+  public:
+    basic_feistel_permutation() = default;
+
+    /**
+     * @brief Construct a new basic_feistel_permutation object.
+     *
+     * @param domain The size of the domain, in [1, 2^62].
+     * @param round The keyed round function, different keys give unrelated permutations.
+     * @throw std::invalid_argument if domain is out of range.
+     */
+    constexpr basic_feistel_permutation(uint64_t domain, Round round) : domain_(domain), round_(round) {
+        if (domain == 0 || domain > (1ULL << 62)) {
+            throw std::invalid_argument("The domain of a permutation must be in [1, 2^62].");
+        }
+        int bits = std::max(2, static_cast<int>(std::bit_width(domain - 1)));
+        left_bits_ = bits / 2;
+        right_bits_ = bits - left_bits_;
+    }
+
+    [[nodiscard]] constexpr uint64_t domain() const noexcept { return domain_; }
+
+    /// Map x in [0, domain) to its image in [0, domain).
+    [[nodiscard]] constexpr uint64_t operator()(uint64_t x) const noexcept {
+        do {
+            x = encrypt(x);
+        } while (x >= domain_);
+        return x;
+    }
+
+    /// The inverse of operator(), y must be in [0, domain).
+    [[nodiscard]] constexpr uint64_t inverse(uint64_t y) const noexcept {
+        do {
+            y = decrypt(y);
+        } while (y >= domain_);
+        return y;
+    }
+};
+
+/// A fast permutation for spreading values, not a cipher.
+using feistel_permutation = basic_feistel_permutation<mix_round>;
+
+/// A format-preserving cipher under a 128-bit key, in the style of FF1 with SipHash as its pseudorandom function.
+using keyed_feistel_permutation = basic_feistel_permutation<siphash_round>;
+
+} // namespace idlib::detail
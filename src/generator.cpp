@@ -0,0 +1,89 @@
+#include "generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "calendar.h"
+
+namespace idlib {
+
+namespace detail {
+
+std::vector<double> region_weights(const generator_weights &weights) {
+    auto codes = std::span(kRegionCodes).first(kRegionCodeCount);
+    std::vector<double> result(codes.size());
+    for (const auto &[prefix, weight] : weights.regions) {
+        if (prefix.empty() || prefix.size() > 6 ||
+            !std::all_of(prefix.begin(), prefix.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            throw std::invalid_argument("A region prefix must be 1 to 6 digits.");
+        }
+        if (!std::isfinite(weight) || weight < 0) {
+            throw std::invalid_argument("Weights must be finite and non-negative.");
+        }
+        auto first = std::lower_bound(codes.begin(), codes.end(), prefix);
+        auto last = std::find_if(first, codes.end(), [&](std::string_view code) { return !code.starts_with(prefix); });
+        if (first == last) {
+            throw std::invalid_argument("The region prefix " + prefix + " matches no region code.");
+        }
+        auto share = weight / static_cast<double>(last - first);
+        for (auto it = first; it != last; ++it) {
+            result[it - codes.begin()] += share;
+        }
+    }
+    return result;
+}
+
+void check_birth_years(const generator_weights &weights) {
+    double sum = 0;
+    for (auto [year, weight] : weights.birth_years) {
+        if (!std::isfinite(weight) || weight < 0) {
+            throw std::invalid_argument("Weights must be finite and non-negative.");
+        }
+        sum += weight;
+    }
+    if (sum <= 0) {
+        throw std::invalid_argument("The sum of the weights must be positive.");
+    }
+}
+
+} // namespace detail
+
+unique_generator::unique_generator(uint64_t key, std::chrono::year_month_day start, std::chrono::year_month_day end) {
+    if (!start.ok() || !end.ok() || start > end) {
+        throw std::invalid_argument("The date range is invalid.");
+    }
+    first_day_ = detail::to_day_serial(start);
+    days_ = static_cast<uint32_t>(detail::to_day_serial(end) - first_day_ + 1);
+    permutation_ = detail::feistel_permutation(detail::distinct_regions().size() * days_ * 1000, key);
+}
+
+void unique_generator::generate(uint64_t i, char *out) const {
+    if (i >= size()) {
+        throw std::out_of_range("The index is out of range.");
+    }
+    uint64_t value = permutation_(i);
+    auto tail = static_cast<unsigned>(value % 1000); // registry code and sequence code
+    value /= 1000;
+    auto day = static_cast<int32_t>(value % days_);
+    auto region = kRegionCodes[detail::distinct_regions()[value / days_]];
+
+    std::copy(region.begin(), region.end(), out);
+    auto ymd = detail::from_day_serial(first_day_ + day);
+    auto date = static_cast<unsigned>(static_cast<int>(ymd.year()) * 10000 + static_cast<unsigned>(ymd.month()) * 100 +
+                                      static_cast<unsigned>(ymd.day()));
+    for (int k = 13; k >= 6; k--, date /= 10) {
+        out[k] = static_cast<char>('0' + date % 10);
+    }
+    for (int k = 16; k >= 14; k--, tail /= 10) {
+        out[k] = static_cast<char>('0' + tail % 10);
+    }
+    out[17] = mod11_2::kCheckDigits[mod11_2::weighted_sum({out, 17}) % 11];
+}
+
+std::string unique_generator::generate(uint64_t i) const {
+    std::string result(18, '\0');
+    generate(i, result.data());
+    return result;
+}
+
+} // namespace idlib
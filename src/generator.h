@@ -7,17 +7,107 @@
  * 此外，本生成器的生成器并未进行单元测试，如有问题，请提交Issue。
  */
 #pragma once
+#include <algorithm>
 #include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
+#include "alias-table.h"
 #include "details.h"
+#include "exhaustor.h"
+#include "feistel.h"
+#include "id-set.h"
 #include "mod11-2.h"
 #include "region-codes.h"
+#include "trace.h"
 
 namespace idlib {
 
+/**
+ * @brief Weights that skew the output of a generator towards realistic data, an empty table keeps the uniform
+ * behaviour.
+ */
+struct generator_weights {
+    /// Region code prefixes (1 to 6 digits) and their weights, a weight is split evenly among the matching codes.
+    std::vector<std::pair<std::string, double>> regions{};
+    /// Birth years and their weights, the day is uniform within the year.
+    std::vector<std::pair<int, double>> birth_years{};
+    /// The probability that an id is male.
+    double male_ratio = 0.5;
+};
+
+namespace detail {
+
+/**
+ * @brief Spread the region prefix weights over the real entries of kRegionCodes.
+ *
+ * @throw std::invalid_argument if a prefix is malformed or matches no region code.
+ */
+std::vector<double> region_weights(const generator_weights &weights);
+
+/**
+ * @brief Check the birth year weights.
+ *
+ * @throw std::invalid_argument if a weight is negative or not finite, or they sum to 0.
+ */
+void check_birth_years(const generator_weights &weights);
+
+} // namespace detail
+
+/**
+ * @brief Generates valid ids that are unique by construction.
+ *
+ * The i-th id is the image of i under a keyed permutation of the space region x day of birth x registry code x
+ * sequence code, decoded back into an id. There is no state besides the key and the date range, so any thread can
+ * produce any index and no dedup set is needed.
+ */
+class unique_generator {
+
+    detail::feistel_permutation permutation_{};
+    int32_t first_day_{};
+    uint32_t days_{};
+
+  public:
+    /**
+     * @brief Construct a new unique_generator object.
+     *
+     * @param key The key of the permutation, the same key and range give the same sequence.
+     * @param start The first date of birth.
+     * @param end The last date of birth.
+     * @throw std::invalid_argument if the dates are invalid or start is after end.
+     */
+    unique_generator(uint64_t key, std::chrono::year_month_day start, std::chrono::year_month_day end);
+
+    /// The number of distinct ids, generate accepts indices in [0, size()).
+    [[nodiscard]] uint64_t size() const noexcept { return permutation_.domain(); }
+
+    /**
+     * @brief Write the i-th id to out.
+     *
+     * @param out 18 characters, no null terminator is written.
+     * @throw std::out_of_range if i is not less than size().
+     */
+    void generate(uint64_t i, char *out) const;
+
+    /**
+     * @brief Generate the i-th id.
+     *
+     * @throw std::out_of_range if i is not less than size().
+     */
+    [[nodiscard]] std::string generate(uint64_t i) const;
+};
+
 template <typename Random> class generator {
 
     Random &random_;
+    alias_table regions_{};
+    std::vector<std::pair<int, double>> birth_years_{};
+    alias_table years_{}; // birth_years_ restricted to [years_start_, years_end_]
+    std::vector<int> year_values_{};
+    std::chrono::local_days years_start_{};
+    std::chrono::local_days years_end_{};
+    double male_ratio_ = 0.5;
 
     template <class T = int>
     T random_num(T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max()) {
@@ -25,19 +115,72 @@ template <typename Random> class generator {
         return dist(random_);
     }
 
+    /**
+     * @brief Rebuild the birth year table for a date range unless it was built for the same range.
+     *
+     * Years that don't overlap the range are dropped and the remaining weights are renormalized.
+     *
+     * @throw std::invalid_argument if no year with a positive weight overlaps the range.
+     */
+    void build_years(std::chrono::local_days start, std::chrono::local_days end) {
+        if (!years_.empty() && years_start_ == start && years_end_ == end) {
+            return;
+        }
+        std::vector<double> table;
+        std::vector<int> values;
+        for (auto [year, weight] : birth_years_) {
+            std::chrono::year y(year);
+            if (weight > 0 && (std::chrono::local_days)(y / std::chrono::January / 1) <= end &&
+                (std::chrono::local_days)(y / std::chrono::December / 31) >= start) {
+                values.push_back(year);
+                table.push_back(weight);
+            }
+        }
+        if (values.empty()) {
+            throw std::invalid_argument("No weighted birth year overlaps the date range.");
+        }
+        years_ = alias_table(table);
+        year_values_ = std::move(values);
+        years_start_ = start;
+        years_end_ = end;
+    }
+
   public:
     enum part : uint64_t {
         kRegionCode = 0x1,
         kDateOfBirth = 0x2,
         kCheckCode = 0x4,
-        kAll = 0x5 - 1,
+        kAll = 0x8 - 1,
     };
 
     explicit generator(Random &random) : random_(random) {}
 
+    /**
+     * @brief Construct a new generator object that draws regions, birth years and sexes from weight tables.
+     *
+     * The region table is built here once and the birth year table once per date range, so a weighted draw costs the
+     * same as a uniform one. Drawing a valid date throws std::invalid_argument if no weighted year overlaps the range.
+     *
+     * @throw std::invalid_argument if a weight table is invalid or male_ratio is not in [0, 1].
+     */
+    generator(Random &random, const generator_weights &weights) : random_(random), male_ratio_(weights.male_ratio) {
+        if (!(male_ratio_ >= 0 && male_ratio_ <= 1)) {
+            throw std::invalid_argument("The male ratio must be in [0, 1].");
+        }
+        if (!weights.regions.empty()) {
+            auto table = detail::region_weights(weights);
+            regions_ = alias_table(table);
+        }
+        if (!weights.birth_years.empty()) {
+            detail::check_birth_years(weights);
+            birth_years_ = weights.birth_years;
+        }
+    }
+
     std::string random_region(bool isValid) {
         if (isValid) {
-            return std::string(kRegionCodes[random_num<size_t>(0, kRegionCodes.size() - 1)]);
+            auto index = regions_.empty() ? random_num<size_t>(0, detail::kRegionCodeCount - 1) : regions_(random_);
+            return std::string(kRegionCodes[index]);
         } else {
             std::string result(6, '0');
             do {
@@ -53,6 +196,13 @@ template <typename Random> class generator {
         if (isValid) {
             auto days_start = (std::chrono::local_days)start;
             auto days_end = (std::chrono::local_days)end;
+            if (!birth_years_.empty()) {
+                // Only years overlapping the range are drawn, the day is uniform within the clipped year.
+                build_years(days_start, days_end);
+                std::chrono::year year(year_values_[years_(random_)]);
+                days_start = std::max(days_start, (std::chrono::local_days)(year / std::chrono::January / 1));
+                days_end = std::min(days_end, (std::chrono::local_days)(year / std::chrono::December / 31));
+            }
             auto days = random_num(days_start.time_since_epoch().count(), days_end.time_since_epoch().count());
             std::chrono::year_month_day ymd{std::chrono::local_days(std::chrono::days(days))};
             return detail::ymd2str(ymd);
@@ -99,23 +249,77 @@ template <typename Random> class generator {
         return std::to_string(num);
     }
 
-    std::string random_sequence_code() { return std::to_string(random_num(0, 9)); }
+    std::string random_sequence_code() {
+        if (male_ratio_ == 0.5) {
+            return std::to_string(random_num(0, 9));
+        }
+        // Odd sequence codes are male.
+        bool male = std::bernoulli_distribution(male_ratio_)(random_);
+        return std::to_string(random_num(0, 4) * 2 + male);
+    }
 
     std::string generate_valid(std::chrono::year_month_day start, std::chrono::year_month_day end) {
         std::string result;
-        result += random_region(true);
-        result += random_date(true, start, end);
-        result += random_registry_code();
-        result += random_sequence_code();
+        {
+            IDLIB_TRACE_SCOPE("generator.region_code");
+            result += random_region(true);
+        }
+        {
+            IDLIB_TRACE_SCOPE("generator.date_of_birth");
+            result += random_date(true, start, end);
+        }
+        {
+            IDLIB_TRACE_SCOPE("generator.registry_code");
+            result += random_registry_code();
+            result += random_sequence_code();
+        }
+        IDLIB_TRACE_SCOPE("generator.check_code");
         result += mod11_2::do_mod11_2(result);
         return result;
     }
 
+    /**
+     * @brief Generate a valid id that is not in the set yet and add it to the set.
+     *
+     * @param seen The ids generated so far.
+     */
+    std::string generate_unique(id_set &seen, std::chrono::year_month_day start, std::chrono::year_month_day end) {
+        std::string result;
+        do {
+            result = generate_valid(start, end);
+        } while (!seen.insert(result));
+        return result;
+    }
+
+    /**
+     * @brief Generate a valid id that matches a template, drawn uniformly from all of the matching ids.
+     *
+     * @param tmpl The template, see exhaustor::sample(). Its candidate tables are built once and reused by later
+     * draws from the same exhaustor.
+     * @throw std::invalid_argument if no id matches the template.
+     */
+    std::string generate_matching(exhaustor &tmpl, std::chrono::year_month_day start, std::chrono::year_month_day end) {
+        IDLIB_TRACE_SCOPE("generator.generate_matching");
+        return tmpl.sample(random_, start, end);
+    }
+
+    /**
+     * @brief Generate a valid id that matches a template like "11****1990******m*".
+     *
+     * @throw std::invalid_argument if the template is malformed or no id matches it.
+     */
+    std::string generate_matching(const std::string &tmpl, std::chrono::year_month_day start,
+                                  std::chrono::year_month_day end) {
+        IDLIB_TRACE_SCOPE("generator.generate_matching");
+        exhaustor ex(tmpl);
+        return ex.sample(random_, start, end);
+    }
+
     std::string generate_invalid(bool invalidRegion, bool invalidDate, bool invalidCheckCode,
                                  std::chrono::year_month_day start, std::chrono::year_month_day end) {
         std::string result;
-        result += random_region(invalidRegion);
-        result += random_date(invalidDate, start, end);
+        result += random_region(!invalidRegion);
+        result += random_date(!invalidDate, start, end);
         result += random_registry_code();
         result += random_sequence_code();
         if (invalidCheckCode) {
@@ -136,6 +340,7 @@ template <typename Random> class generator {
              std::chrono::year_month_day start = {std::chrono::year(1920), std::chrono::month(1), std::chrono::day(1)},
              std::chrono::year_month_day end = std::chrono::year_month_day{std::chrono::local_days(
                  std::chrono::duration_cast<std::chrono::days>(std::chrono::system_clock::now().time_since_epoch()))}) {
+        IDLIB_TRACE_SCOPE("generator.generate");
         if (validParts == part::kAll) {
             return generate_valid(start, end);
         }
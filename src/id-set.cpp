@@ -0,0 +1,209 @@
+#include "id-set.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace idlib {
+
+namespace {
+
+constexpr uint64_t kEmpty = kInvalidPackedId;
+constexpr size_t kMinCapacity = 16;
+constexpr size_t kPrefetchDistance = 16;
+
+// The finalizer of MurmurHash3, packed ids are dense numbers so the bits need to be mixed before masking.
+constexpr uint64_t mix(uint64_t key) noexcept {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+inline void prefetch(const void *ptr) noexcept {
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char *>(ptr), _MM_HINT_T0);
+#else
+    __builtin_prefetch(ptr);
+#endif
+}
+
+// Keep the load factor at or below 3/4, linear probing degrades quickly above that.
+constexpr size_t capacity_for(size_t count) noexcept {
+    return std::max(kMinCapacity, std::bit_ceil(count + count / 3 + 1));
+}
+
+} // namespace
+
+id_set::id_set(size_t expected) { rehash(capacity_for(expected)); }
+
+size_t id_set::slot_of(uint64_t key) const noexcept { return mix(key) & (slots_.size() - 1); }
+
+bool id_set::insert_unchecked(uint64_t key) noexcept {
+    auto mask = slots_.size() - 1;
+    for (auto i = slot_of(key);; i = (i + 1) & mask) {
+        if (slots_[i] == key) {
+            return false;
+        }
+        if (slots_[i] == kEmpty) {
+            slots_[i] = key;
+            ++size_;
+            return true;
+        }
+    }
+}
+
+void id_set::rehash(size_t capacity) {
+    std::vector<uint64_t> old(capacity, kEmpty);
+    old.swap(slots_);
+    size_ = 0;
+    for (auto key : old) {
+        if (key != kEmpty) {
+            insert_unchecked(key);
+        }
+    }
+}
+
+bool id_set::insert(uint64_t key) {
+    if (key == kEmpty) {
+        throw std::invalid_argument("Cannot insert an invalid packed id.");
+    }
+    reserve(size_ + 1);
+    return insert_unchecked(key);
+}
+
+bool id_set::insert(std::string_view id) {
+    auto key = pack_id(id);
+    if (key == kEmpty) {
+        return false;
+    }
+    return insert(key);
+}
+
+size_t id_set::insert(std::span<const uint64_t> keys, bool *inserted) {
+    reserve(size_ + keys.size());
+    size_t count = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i + kPrefetchDistance < keys.size()) {
+            prefetch(&slots_[slot_of(keys[i + kPrefetchDistance])]);
+        }
+        bool is_new = keys[i] != kEmpty && insert_unchecked(keys[i]);
+        count += is_new;
+        if (inserted) {
+            inserted[i] = is_new;
+        }
+    }
+    return count;
+}
+
+bool id_set::contains(uint64_t key) const noexcept {
+    if (key == kEmpty) {
+        return false;
+    }
+    auto mask = slots_.size() - 1;
+    for (auto i = slot_of(key);; i = (i + 1) & mask) {
+        if (slots_[i] == key) {
+            return true;
+        }
+        if (slots_[i] == kEmpty) {
+            return false;
+        }
+    }
+}
+
+bool id_set::contains(std::string_view id) const noexcept { return contains(pack_id(id)); }
+
+size_t id_set::contains(std::span<const uint64_t> keys, bool *found) const noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i + kPrefetchDistance < keys.size()) {
+            prefetch(&slots_[slot_of(keys[i + kPrefetchDistance])]);
+        }
+        found[i] = contains(keys[i]);
+        count += found[i];
+    }
+    return count;
+}
+
+void id_set::reserve(size_t count) {
+    auto capacity = capacity_for(count);
+    if (capacity > slots_.size()) {
+        rehash(capacity);
+    }
+}
+
+void id_set::clear() noexcept {
+    std::fill(slots_.begin(), slots_.end(), kEmpty);
+    size_ = 0;
+}
+
+size_t id_set::size() const noexcept { return size_; }
+
+bool id_set::empty() const noexcept { return size_ == 0; }
+
+size_t id_set::capacity() const noexcept { return slots_.size() / 4 * 3; }
+
+id_bloom_filter::id_bloom_filter(size_t expected, size_t bits_per_key)
+    : blocks_(std::bit_ceil(std::max<size_t>(1, (expected * bits_per_key + 511) / 512))) {
+    // k = bits_per_key * ln(2), each probe takes 9 bits of the hash so at most 7 fit.
+    hashes_ = static_cast<unsigned>(std::clamp<size_t>((bits_per_key * 69 + 50) / 100, 1, 7));
+    for (auto &b : blocks_) {
+        std::fill(std::begin(b.words), std::end(b.words), 0);
+    }
+}
+
+size_t id_bloom_filter::block_of(uint64_t hash) const noexcept { return (hash >> 32) & (blocks_.size() - 1); }
+
+void id_bloom_filter::insert(uint64_t key) noexcept {
+    auto hash = mix(key);
+    auto &b = blocks_[block_of(hash)];
+    auto bits = mix(hash);
+    for (unsigned i = 0; i < hashes_; i++, bits >>= 9) {
+        auto bit = bits & 511;
+        b.words[bit >> 6] |= uint64_t{1} << (bit & 63);
+    }
+}
+
+void id_bloom_filter::insert(std::span<const uint64_t> keys) noexcept {
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i + kPrefetchDistance < keys.size()) {
+            prefetch(&blocks_[block_of(mix(keys[i + kPrefetchDistance]))]);
+        }
+        insert(keys[i]);
+    }
+}
+
+bool id_bloom_filter::maybe_contains(uint64_t key) const noexcept {
+    auto hash = mix(key);
+    auto &b = blocks_[block_of(hash)];
+    auto bits = mix(hash);
+    for (unsigned i = 0; i < hashes_; i++, bits >>= 9) {
+        auto bit = bits & 511;
+        if (!((b.words[bit >> 6] >> (bit & 63)) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t id_bloom_filter::maybe_contains(std::span<const uint64_t> keys, bool *found) const noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i + kPrefetchDistance < keys.size()) {
+            prefetch(&blocks_[block_of(mix(keys[i + kPrefetchDistance]))]);
+        }
+        found[i] = maybe_contains(keys[i]);
+        count += found[i];
+    }
+    return count;
+}
+
+size_t id_bloom_filter::size_in_bytes() const noexcept { return blocks_.size() * sizeof(block); }
+
+} // namespace idlib
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "packed-id.h"
+
+namespace idlib {
+
+/**
+ * @brief An open addressing hash set of packed ids.
+ *
+ * Each entry takes a single 64-bit slot and the load factor is kept at or below 3/4, lookups probe linearly from
+ * the hashed slot so a hit or miss usually touches a single cache line. The batch functions prefetch the slots of
+ * upcoming keys while the current ones are processed.
+ */
+class id_set {
+
+    std::vector<uint64_t> slots_{};
+    size_t size_{};
+
+    [[nodiscard]] size_t slot_of(uint64_t key) const noexcept;
+    bool insert_unchecked(uint64_t key) noexcept;
+    void rehash(size_t capacity);
+
+  public:
+    /**
+     * @brief Construct a new id_set object.
+     *
+     * @param expected The number of ids to reserve room for.
+     */
+    explicit id_set(size_t expected = 0);
+
+    /**
+     * @brief Insert a packed id.
+     *
+     * @return true if the id was not in the set.
+     * @throw std::invalid_argument if the key is kInvalidPackedId.
+     */
+    bool insert(uint64_t key);
+
+    /**
+     * @brief Insert an id.
+     *
+     * @return true if the id is well-formed and was not in the set.
+     */
+    bool insert(std::string_view id);
+
+    /**
+     * @brief Insert packed ids in a batch.
+     *
+     * @param keys The packed ids, kInvalidPackedId entries are skipped.
+     * @param inserted If not null, inserted[i] is set to whether keys[i] was new.
+     * @return size_t The number of new ids.
+     */
+    size_t insert(std::span<const uint64_t> keys, bool *inserted = nullptr);
+
+    [[nodiscard]] bool contains(uint64_t key) const noexcept;
+
+    [[nodiscard]] bool contains(std::string_view id) const noexcept;
+
+    /**
+     * @brief Look up packed ids in a batch.
+     *
+     * @param keys The packed ids.
+     * @param found found[i] is set to whether keys[i] is in the set.
+     * @return size_t The number of ids found.
+     */
+    size_t contains(std::span<const uint64_t> keys, bool *found) const noexcept;
+
+    /**
+     * @brief Make room for at least count ids without rehashing.
+     */
+    void reserve(size_t count);
+
+    void clear() noexcept;
+
+    [[nodiscard]] size_t size() const noexcept;
+
+    [[nodiscard]] bool empty() const noexcept;
+
+    [[nodiscard]] size_t capacity() const noexcept;
+};
+
+/**
+ * @brief A blocked Bloom filter of packed ids.
+ *
+ * All bits of a key live in the same 64-byte block, so a query costs one cache miss. Use it in front of an id_set
+ * or a slower store when most lookups are expected to miss.
+ */
+class id_bloom_filter {
+
+    struct alignas(64) block {
+        uint64_t words[8];
+    };
+
+    std::vector<block> blocks_{};
+    unsigned hashes_{};
+
+    [[nodiscard]] size_t block_of(uint64_t hash) const noexcept;
+
+  public:
+    /**
+     * @brief Construct a new id_bloom_filter object.
+     *
+     * @param expected The expected number of ids.
+     * @param bits_per_key The number of filter bits per id, 10 gives about 1% false positives.
+     */
+    explicit id_bloom_filter(size_t expected, size_t bits_per_key = 10);
+
+    void insert(uint64_t key) noexcept;
+
+    void insert(std::span<const uint64_t> keys) noexcept;
+
+    /**
+     * @brief Check if a key may be in the filter, false positives are possible but false negatives are not.
+     */
+    [[nodiscard]] bool maybe_contains(uint64_t key) const noexcept;
+
+    /**
+     * @brief Check keys in a batch.
+     *
+     * @return size_t The number of keys that may be in the filter.
+     */
+    size_t maybe_contains(std::span<const uint64_t> keys, bool *found) const noexcept;
+
+    [[nodiscard]] size_t size_in_bytes() const noexcept;
+};
+
+} // namespace idlib
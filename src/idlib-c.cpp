@@ -0,0 +1,126 @@
+#include "idlib-c.h"
+#include "generator.h"
+#include "mod11-2.h"
+#include "validator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace {
+
+using namespace std::chrono;
+
+static_assert(sizeof(idlib_decoded) == 12);
+static_assert(IDLIB_ERROR_CHECK_CODE == static_cast<int>(idlib::id_error::kCheckCode));
+
+year_month_day to_ymd(uint32_t date) noexcept {
+    if (date == 0) {
+        return {};
+    }
+    return year(static_cast<int>(date / 10000)) / month(date / 100 % 100) / day(date % 100);
+}
+
+// Converts the bounds, 0 is unbounded. Fails if another bound is not a real date or the bounds are reversed, decode()
+// would silently ignore such a bound.
+bool to_range(uint32_t date_min, uint32_t date_max, std::pair<year_month_day, year_month_day> &range) noexcept {
+    range = {to_ymd(date_min), to_ymd(date_max)};
+    if ((date_min != 0 && !range.first.ok()) || (date_max != 0 && !range.second.ok())) {
+        return false;
+    }
+    return date_min == 0 || date_max == 0 || range.first <= range.second;
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t idlib_abi_version(void) { return IDLIB_ABI_VERSION; }
+
+const char *idlib_error_message(int error) {
+    switch (error) {
+    case IDLIB_OK:
+        return "The id is valid.";
+    case IDLIB_ERROR_LENGTH:
+        return "The length of the id must be 18.";
+    case IDLIB_ERROR_CHARACTER:
+        return "The id must only contain digits, 'X' and 'x'.";
+    case IDLIB_ERROR_REGION_CODE:
+        return "The region code is invalid.";
+    case IDLIB_ERROR_DATE_OF_BIRTH:
+        return "The date of birth is invalid.";
+    case IDLIB_ERROR_CHECK_CODE:
+        return "The check code is invalid.";
+    default:
+        return "Unknown error.";
+    }
+}
+
+size_t idlib_validate(const char *records, size_t count, size_t stride, uint32_t date_min, uint32_t date_max,
+                      uint8_t *errors) {
+    std::pair<year_month_day, year_month_day> range;
+    if (!records || stride < IDLIB_ID_LENGTH || !to_range(date_min, date_max, range)) {
+        return 0;
+    }
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto id = idlib::validator::decode({records + i * stride, IDLIB_ID_LENGTH}, range);
+        valid += id.ok();
+        if (errors) {
+            errors[i] = static_cast<uint8_t>(id.error);
+        }
+    }
+    return valid;
+}
+
+size_t idlib_decode(const char *records, size_t count, size_t stride, uint32_t date_min, uint32_t date_max,
+                    idlib_decoded *out) {
+    std::pair<year_month_day, year_month_day> range;
+    if (!records || !out || stride < IDLIB_ID_LENGTH || !to_range(date_min, date_max, range)) {
+        return 0;
+    }
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto id = idlib::validator::decode({records + i * stride, IDLIB_ID_LENGTH}, range);
+        valid += id.ok();
+        out[i] = {id.date_of_birth, id.region_index, id.sex, id.check_code, static_cast<uint8_t>(id.error), {}};
+    }
+    return valid;
+}
+
+size_t idlib_check_codes(const char *records, size_t count, size_t stride, char *out) {
+    if (!records || !out || stride < IDLIB_ID_LENGTH - 1) {
+        return 0;
+    }
+    size_t ok = 0;
+    for (size_t i = 0; i < count; i++) {
+        std::string_view digits(records + i * stride, IDLIB_ID_LENGTH - 1);
+        if (std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            out[i] = idlib::mod11_2::kCheckDigits[idlib::mod11_2::weighted_sum(digits) % 11];
+            ++ok;
+        } else {
+            out[i] = '\0';
+        }
+    }
+    return ok;
+}
+
+size_t idlib_generate(char *out, size_t count, size_t stride, uint64_t seed, uint32_t date_min, uint32_t date_max) {
+    auto start = to_ymd(date_min);
+    auto end = to_ymd(date_max);
+    if (!out || stride < IDLIB_ID_LENGTH || !start.ok() || !end.ok() || start > end) {
+        return 0;
+    }
+    try {
+        std::mt19937_64 random(seed);
+        idlib::generator gen(random);
+        for (size_t i = 0; i < count; i++) {
+            gen.generate_valid(start, end).copy(out + i * stride, IDLIB_ID_LENGTH);
+        }
+    } catch (...) {
+        return 0;
+    }
+    return count;
+}
+
+} // extern "C"
@@ -0,0 +1,97 @@
+/*
+ * Stable C ABI of idlib for foreign-language callers.
+ *
+ * The batch entry points take arrays of fixed-width records: record i starts at records + i * stride and its first
+ * 18 bytes are the id (no terminator needed), so NumPy "S18" arrays, newline separated text (stride 19) and
+ * structs with an id field can be passed without copying. Results are written to caller-owned arrays.
+ * No function throws or keeps pointers after it returns.
+ */
+#ifndef IDLIB_C_H
+#define IDLIB_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(IDLIB_C_SHARED)
+#if defined(IDLIB_C_BUILD)
+#define IDLIB_C_API __declspec(dllexport)
+#else
+#define IDLIB_C_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define IDLIB_C_API __attribute__((visibility("default")))
+#else
+#define IDLIB_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IDLIB_ABI_VERSION 1
+#define IDLIB_ID_LENGTH 18
+
+/* Same values as idlib::id_error. */
+enum idlib_error {
+    IDLIB_OK = 0,
+    IDLIB_ERROR_LENGTH = 1,
+    IDLIB_ERROR_CHARACTER = 2,
+    IDLIB_ERROR_REGION_CODE = 3,
+    IDLIB_ERROR_DATE_OF_BIRTH = 4,
+    IDLIB_ERROR_CHECK_CODE = 5,
+};
+
+/* Same fields as idlib::decoded_id, with a fixed layout of 12 bytes. */
+typedef struct idlib_decoded {
+    uint32_t date_of_birth; /* yyyymmdd */
+    uint16_t region_index;  /* index into the region code table */
+    uint8_t sex;            /* 1 = male, 0 = female */
+    uint8_t check_code;     /* 0-9, 10 for 'X' */
+    uint8_t error;          /* enum idlib_error */
+    uint8_t reserved[3];
+} idlib_decoded;
+
+/*
+ * Dates are passed as yyyymmdd integers, e.g. 19190810. For idlib_validate and idlib_decode a bound of 0 means
+ * unbounded on that side, any other bound must be a real calendar date and date_min must not be after date_max,
+ * otherwise the call returns 0 and writes nothing.
+ */
+
+/* Returns IDLIB_ABI_VERSION of the loaded library. */
+IDLIB_C_API uint32_t idlib_abi_version(void);
+
+/* Returns a static English message for an idlib_error value. */
+IDLIB_C_API const char *idlib_error_message(int error);
+
+/*
+ * Validates count records born in [date_min, date_max], errors[i] receives the idlib_error of record i (errors may
+ * be NULL). Returns the number of valid records, or 0 if the arguments are invalid.
+ */
+IDLIB_C_API size_t idlib_validate(const char *records, size_t count, size_t stride, uint32_t date_min,
+                                  uint32_t date_max, uint8_t *errors);
+
+/*
+ * Decodes count records born in [date_min, date_max] into out[0..count). Returns the number of valid records, or 0
+ * if the arguments are invalid.
+ */
+IDLIB_C_API size_t idlib_decode(const char *records, size_t count, size_t stride, uint32_t date_min,
+                                uint32_t date_max, idlib_decoded *out);
+
+/*
+ * Computes the mod 11-2 check code of the first 17 digits of count records (stride may be 17), out[i] receives
+ * '0'-'9' or 'X', or 0 if the digits are malformed. Returns the number of well-formed records.
+ */
+IDLIB_C_API size_t idlib_check_codes(const char *records, size_t count, size_t stride, char *out);
+
+/*
+ * Generates count random valid ids born in [date_min, date_max] into out, record i is written at out + i * stride.
+ * Both dates are required here. The same seed gives the same ids. Returns count, or 0 if the arguments are invalid.
+ */
+IDLIB_C_API size_t idlib_generate(char *out, size_t count, size_t stride, uint64_t seed, uint32_t date_min,
+                                  uint32_t date_max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IDLIB_C_H */
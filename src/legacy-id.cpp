@@ -0,0 +1,145 @@
+#include "legacy-id.h"
+#include "mod11-2.h"
+
+#include <stdexcept>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace idlib {
+
+namespace {
+
+using date_range = std::pair<std::chrono::year_month_day, std::chrono::year_month_day>;
+
+constexpr size_t kLegacyLength = std::tuple_size_v<legacy_id_record>;
+
+// The weighted sum of the inserted century digits "19".
+constexpr int kCenturySum = 1 * mod11_2::kFactors[6] + 9 * mod11_2::kFactors[7];
+
+// The factor of each legacy position, positions from the year on move 2 places right in the upgraded id.
+constexpr int legacy_factor(size_t i) { return mod11_2::kFactors[i < 6 ? i : i + 2]; }
+
+// Write the upgraded id without its check code and return the weighted sum, or -1 if a character is not a digit.
+int upgrade_scalar(const char *id, char *out) noexcept {
+    int sum = kCenturySum;
+    for (size_t i = 0; i < kLegacyLength; i++) {
+        auto digit = static_cast<unsigned>(id[i] - '0');
+        if (digit > 9) {
+            return -1;
+        }
+        sum += static_cast<int>(digit) * legacy_factor(i);
+        out[i < 6 ? i : i + 2] = id[i];
+    }
+    out[6] = '1';
+    out[7] = '9';
+    return sum;
+}
+
+#if defined(__SSSE3__)
+
+// Same as upgrade_scalar on 16 loaded bytes, the last one belongs to the next record and is ignored. The digits are
+// checked with an unsigned compare, summed with pmaddubsw and moved into place with a single pshufb.
+int upgrade_simd(__m128i bytes, char *out) noexcept {
+    auto digits = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    if ((_mm_movemask_epi8(is_digit) & 0x7fff) != 0x7fff) {
+        return -1;
+    }
+    const auto factors = _mm_setr_epi8(legacy_factor(0), legacy_factor(1), legacy_factor(2), legacy_factor(3),
+                                       legacy_factor(4), legacy_factor(5), legacy_factor(6), legacy_factor(7),
+                                       legacy_factor(8), legacy_factor(9), legacy_factor(10), legacy_factor(11),
+                                       legacy_factor(12), legacy_factor(13), legacy_factor(14), 0);
+    auto pairs = _mm_madd_epi16(_mm_maddubs_epi16(digits, factors), _mm_set1_epi16(1));
+    pairs = _mm_add_epi32(pairs, _mm_shuffle_epi32(pairs, _MM_SHUFFLE(1, 0, 3, 2)));
+    pairs = _mm_add_epi32(pairs, _mm_shuffle_epi32(pairs, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    const auto spread = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, 12, 13);
+    const auto century = _mm_setr_epi8(0, 0, 0, 0, 0, 0, '1', '9', 0, 0, 0, 0, 0, 0, 0, 0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_or_si128(_mm_shuffle_epi8(bytes, spread), century));
+    out[16] = static_cast<char>(_mm_extract_epi16(bytes, 7) & 0xff);
+    return kCenturySum + _mm_cvtsi128_si32(pairs);
+}
+
+#endif
+
+// Append the check code and validate the fields that upgrading can't fix.
+decoded_id finish(char *out, int sum, const date_range &range) noexcept {
+    using namespace std::chrono;
+    decoded_id result{};
+    if (sum < 0) {
+        result.error = id_error::kCharacter;
+        return result;
+    }
+    result.check_code = static_cast<uint8_t>(mod11_2::kCheckInts[sum % 11]);
+    out[detail::kCheckCodeIndex] = mod11_2::kCheckDigits[sum % 11];
+    result.sex = static_cast<uint8_t>((out[detail::kSequenceCodeIndex] - '0') & 1);
+
+    auto region = detail::region_index({out + detail::kRegionCodeStart, detail::kRegionCodeLength});
+    if (region < 0) {
+        result.error = id_error::kRegionCode;
+        return result;
+    }
+    result.region_index = static_cast<uint16_t>(region);
+
+    auto digit = [&](size_t i) { return static_cast<unsigned>(out[detail::kDateOfBirthStart + i] - '0'); };
+    unsigned yy = digit(2) * 10 + digit(3);
+    unsigned mm = digit(4) * 10 + digit(5);
+    unsigned dd = digit(6) * 10 + digit(7);
+    result.date_of_birth = (1900 + yy) * 10000 + mm * 100 + dd;
+    auto ymd = year(static_cast<int>(1900 + yy)) / month(mm) / day(dd);
+    if (!ymd.ok() || (range.first.ok() && ymd < range.first) || (range.second.ok() && ymd > range.second)) {
+        result.error = id_error::kDateOfBirth;
+    }
+    return result;
+}
+
+} // namespace
+
+decoded_id upgrade_legacy_id(std::string_view id, char *out, const date_range &valid_date_range) noexcept {
+    if (id.size() != kLegacyLength) {
+        decoded_id result{};
+        result.error = id_error::kLength;
+        return result;
+    }
+    return finish(out, upgrade_scalar(id.data(), out), valid_date_range);
+}
+
+std::string upgrade_legacy_id(std::string_view id) {
+    std::string result(18, '\0');
+    if (!upgrade_legacy_id(id, result.data()).ok()) {
+        throw std::invalid_argument("The id is not a valid 15-digit id.");
+    }
+    return result;
+}
+
+size_t upgrade_legacy_ids(std::span<const legacy_id_record> records, std::span<id_record> out, id_error *errors,
+                          const date_range &valid_date_range) {
+    if (out.size() < records.size()) {
+        throw std::invalid_argument("The output must have room for every record.");
+    }
+    size_t valid = 0;
+    size_t i = 0;
+#if defined(__SSSE3__)
+    // A 16-byte load of the last record would read past the span.
+    for (; i + 1 < records.size(); i++) {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(records[i].data()));
+        auto result = finish(out[i].data(), upgrade_simd(bytes, out[i].data()), valid_date_range);
+        valid += result.ok();
+        if (errors) {
+            errors[i] = result.error;
+        }
+    }
+#endif
+    for (; i < records.size(); i++) {
+        auto result = finish(out[i].data(), upgrade_scalar(records[i].data(), out[i].data()), valid_date_range);
+        valid += result.ok();
+        if (errors) {
+            errors[i] = result.error;
+        }
+    }
+    return valid;
+}
+
+} // namespace idlib
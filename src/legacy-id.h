@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "details.h"
+#include "validator.h"
+
+//
+// First generation PRC ID format:
+// | INDEX | 00 01 | 02 03 | 04 05 | 06 07 | 08 09 | 10 11 | 12 13 | 14 |
+// | FIELD | prov  | cty   | dist  | yob   | mob   | dob   | reg   | sq |
+//
+// * Year of birth: the last two digits, the century is always 19
+// * There is no check code
+//
+
+namespace idlib {
+
+using legacy_id_record = std::array<char, 15>;
+
+/**
+ * @brief Upgrade a 15-digit id to 18 digits and validate the result in the same pass.
+ *
+ * "19" is inserted before the year of birth and the check code is computed with mod 11-2, so the upgraded id can
+ * only fail on its length, characters, region code or date of birth.
+ *
+ * @param id The 15-digit id.
+ * @param out Receives the 18-digit id if the id has 15 digits, no null terminator is written.
+ * @param valid_date_range The valid date range of the date of birth, bounds that are not ok() are ignored.
+ * @return decoded_id The decoded fields of the upgraded id and the first error found.
+ */
+decoded_id upgrade_legacy_id(
+    std::string_view id, char *out,
+    const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range = {}) noexcept;
+
+/**
+ * @brief Upgrade a 15-digit id to 18 digits.
+ *
+ * @return std::string The 18-digit id.
+ * @throw std::invalid_argument if the upgraded id is invalid.
+ */
+std::string upgrade_legacy_id(std::string_view id);
+
+/**
+ * @brief Upgrade and validate 15-digit ids in a batch.
+ *
+ * @param records The 15-digit ids.
+ * @param out Receives the upgraded ids, out[i] is unspecified if records[i] is not all digits.
+ * @param errors If not null, errors[i] is set to the first error of out[i].
+ * @param valid_date_range The valid date range of the date of birth, bounds that are not ok() are ignored.
+ * @return size_t The number of valid ids.
+ * @throw std::invalid_argument if out is smaller than records.
+ */
+size_t upgrade_legacy_ids(
+    std::span<const legacy_id_record> records, std::span<id_record> out, id_error *errors = nullptr,
+    const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range = {});
+
+} // namespace idlib
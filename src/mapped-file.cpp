@@ -0,0 +1,127 @@
+#include "mapped-file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace idlib::detail {
+
+#if defined(_WIN32)
+
+mapped_file::mapped_file(const std::string &path) {
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                        nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        throw std::runtime_error("Failed to open " + path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        close();
+        throw std::runtime_error("Failed to get the size of " + path);
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0) {
+        return;
+    }
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+        close();
+        throw std::runtime_error("Failed to map " + path);
+    }
+    data_ = static_cast<const uint8_t *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        close();
+        throw std::runtime_error("Failed to map " + path);
+    }
+}
+
+void mapped_file::close() noexcept {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+    }
+    if (file_) {
+        CloseHandle(file_);
+    }
+    data_ = nullptr;
+    mapping_ = nullptr;
+    file_ = nullptr;
+    size_ = 0;
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+      file_(std::exchange(other.file_, nullptr)), mapping_(std::exchange(other.mapping_, nullptr)) {}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        file_ = std::exchange(other.file_, nullptr);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+    }
+    return *this;
+}
+
+#else
+
+mapped_file::mapped_file(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to get the size of " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ != 0) {
+        auto ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map " + path);
+        }
+        data_ = static_cast<const uint8_t *>(ptr);
+    }
+    ::close(fd);
+}
+
+void mapped_file::close() noexcept {
+    if (data_) {
+        ::munmap(const_cast<uint8_t *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+#endif
+
+mapped_file::~mapped_file() { close(); }
+
+} // namespace idlib::detail
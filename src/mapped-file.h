@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace idlib::detail {
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ */
+class mapped_file {
+
+    const uint8_t *data_{};
+    size_t size_{};
+#if defined(_WIN32)
+    void *file_{};
+    void *mapping_{};
+#endif
+
+    void close() noexcept;
+
+  public:
+    /**
+     * @brief Map a file.
+     *
+     * @param path The path of the file.
+     * @throw std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit mapped_file(const std::string &path);
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other) noexcept;
+    mapped_file &operator=(mapped_file &&other) noexcept;
+    ~mapped_file();
+
+    [[nodiscard]] const uint8_t *data() const noexcept { return data_; }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+};
+
+} // namespace idlib::detail
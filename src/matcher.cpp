@@ -0,0 +1,135 @@
+#include "matcher.h"
+
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace idlib {
+
+namespace {
+
+#if defined(__SSSE3__)
+
+// Every byte is turned into the index of its bit in the position mask (0-9 for digits, 10 for 'X'/'x', 0x80 for
+// anything else), two pshufb lookups expand the index into the low and high byte of that bit, and the result is
+// tested against the mask bytes of each lane. The 18 bytes are covered by two overlapping loads at offset 0 and 2.
+struct simd_masks {
+    __m128i lo[2];
+    __m128i hi[2];
+
+    explicit simd_masks(const pattern &tmpl) noexcept {
+        alignas(16) uint8_t lo_bytes[2][16];
+        alignas(16) uint8_t hi_bytes[2][16];
+        for (size_t half = 0; half < 2; half++) {
+            for (size_t i = 0; i < 16; i++) {
+                auto mask = tmpl.mask(half * 2 + i);
+                lo_bytes[half][i] = static_cast<uint8_t>(mask & 0xff);
+                hi_bytes[half][i] = static_cast<uint8_t>(mask >> 8);
+            }
+            lo[half] = _mm_load_si128(reinterpret_cast<const __m128i *>(lo_bytes[half]));
+            hi[half] = _mm_load_si128(reinterpret_cast<const __m128i *>(hi_bytes[half]));
+        }
+    }
+};
+
+inline __m128i bit_index(__m128i bytes) noexcept {
+    auto digit = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    auto is_x = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('X')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('x')));
+    auto index = _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_x, _mm_set1_epi8(10)));
+    return _mm_or_si128(index, _mm_andnot_si128(_mm_or_si128(is_digit, is_x), _mm_set1_epi8(char(0x80))));
+}
+
+inline bool match_half(__m128i bytes, __m128i lo, __m128i hi) noexcept {
+    const auto lo_bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, char(128), 0, 0, 0, 0, 0, 0, 0, 0);
+    const auto hi_bits = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 0, 0, 0, 0, 0);
+    auto index = bit_index(bytes);
+    auto hit = _mm_or_si128(_mm_and_si128(_mm_shuffle_epi8(lo_bits, index), lo),
+                            _mm_and_si128(_mm_shuffle_epi8(hi_bits, index), hi));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(hit, _mm_setzero_si128())) == 0;
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+// Same as match_half, two records at once, one per 128-bit lane.
+inline uint32_t match_pair(__m256i bytes, __m256i lo, __m256i hi) noexcept {
+    const auto lo_bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, char(128), 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16,
+                                          32, 64, char(128), 0, 0, 0, 0, 0, 0, 0, 0);
+    const auto hi_bits = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+                                          2, 4, 0, 0, 0, 0, 0);
+    auto digit = _mm256_sub_epi8(bytes, _mm256_set1_epi8('0'));
+    auto is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    auto is_x = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('X')),
+                                _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('x')));
+    auto index = _mm256_or_si256(_mm256_and_si256(is_digit, digit), _mm256_and_si256(is_x, _mm256_set1_epi8(10)));
+    index = _mm256_or_si256(index,
+                            _mm256_andnot_si256(_mm256_or_si256(is_digit, is_x), _mm256_set1_epi8(char(0x80))));
+    auto hit = _mm256_or_si256(_mm256_and_si256(_mm256_shuffle_epi8(lo_bits, index), lo),
+                               _mm256_and_si256(_mm256_shuffle_epi8(hi_bits, index), hi));
+    auto miss = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+    return (miss & 0xffff ? 0 : 1) | (miss >> 16 ? 0 : 2);
+}
+
+#endif
+
+} // namespace
+
+size_t match(const pattern &tmpl, std::span<const id_record> records, uint64_t *bitmap) noexcept {
+    auto size = records.size();
+    for (size_t w = 0; w < (size + 63) / 64; w++) {
+        bitmap[w] = 0;
+    }
+    const char *data = records.empty() ? nullptr : records.data()->data();
+    size_t i = 0;
+#if defined(__SSSE3__)
+    simd_masks masks(tmpl);
+#if defined(__AVX2__)
+    auto lo0 = _mm256_broadcastsi128_si256(masks.lo[0]);
+    auto hi0 = _mm256_broadcastsi128_si256(masks.hi[0]);
+    auto lo1 = _mm256_broadcastsi128_si256(masks.lo[1]);
+    auto hi1 = _mm256_broadcastsi128_si256(masks.hi[1]);
+    for (; i + 2 <= size; i += 2) {
+        auto rec = data + i * 18;
+        auto first = _mm256_loadu2_m128i(reinterpret_cast<const __m128i *>(rec + 18),
+                                         reinterpret_cast<const __m128i *>(rec));
+        auto second = _mm256_loadu2_m128i(reinterpret_cast<const __m128i *>(rec + 20),
+                                          reinterpret_cast<const __m128i *>(rec + 2));
+        uint64_t bits = match_pair(first, lo0, hi0) & match_pair(second, lo1, hi1);
+        bitmap[i / 64] |= bits << (i % 64);
+    }
+#endif
+    for (; i < size; i++) {
+        auto rec = data + i * 18;
+        auto first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rec));
+        auto second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rec + 2));
+        if (match_half(first, masks.lo[0], masks.hi[0]) && match_half(second, masks.lo[1], masks.hi[1])) {
+            bitmap[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+#else
+    for (; i < size; i++) {
+        if (tmpl.match({data + i * 18, 18})) {
+            bitmap[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+#endif
+    size_t count = 0;
+    for (size_t w = 0; w < (size + 63) / 64; w++) {
+        count += static_cast<size_t>(std::popcount(bitmap[w]));
+    }
+    return count;
+}
+
+std::vector<uint64_t> match(const pattern &tmpl, std::span<const id_record> records) {
+    std::vector<uint64_t> bitmap((records.size() + 63) / 64);
+    match(tmpl, records, bitmap.data());
+    return bitmap;
+}
+
+} // namespace idlib
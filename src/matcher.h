@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "details.h"
+#include "pattern.h"
+
+namespace idlib {
+
+/**
+ * @brief Match stored ids against a template, the inverse of exhaustion.
+ *
+ * A record matches if every character is allowed by the corresponding position of the pattern. The check code is
+ * not verified, use validator for that.
+ *
+ * @param tmpl The compiled template.
+ * @param records The ids to be matched.
+ * @param bitmap The selection bitmap, bit i % 64 of bitmap[i / 64] is set if records[i] matches. Must have room
+ * for (records.size() + 63) / 64 words.
+ * @return size_t The number of matched records.
+ */
+size_t match(const pattern &tmpl, std::span<const id_record> records, uint64_t *bitmap) noexcept;
+
+/**
+ * @brief Match stored ids against a template.
+ *
+ * @return std::vector<uint64_t> The selection bitmap, bit i % 64 of word i / 64 is set if records[i] matches.
+ */
+std::vector<uint64_t> match(const pattern &tmpl, std::span<const id_record> records);
+
+} // namespace idlib
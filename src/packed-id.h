@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace idlib {
+
+// A packed id keeps the first 17 digits as a number in the high bits and the check code (0-10) in the low 4 bits,
+// which fits in 61 bits and keeps packed ids in the same order as the strings (with 'X' after '9').
+constexpr uint64_t kInvalidPackedId = ~uint64_t{0};
+
+/**
+ * @brief Pack an id into 64 bits.
+ *
+ * @param id The id, the check code is not verified.
+ * @return uint64_t The packed id, or kInvalidPackedId if the id is not 17 digits followed by a digit or 'X'/'x'.
+ */
+constexpr uint64_t pack_id(std::string_view id) noexcept {
+    if (id.size() != 18) {
+        return kInvalidPackedId;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < 17; i++) {
+        auto digit = static_cast<uint64_t>(id[i] - '0');
+        if (digit > 9) {
+            return kInvalidPackedId;
+        }
+        value = value * 10 + digit;
+    }
+    uint64_t check;
+    if (id[17] >= '0' && id[17] <= '9') {
+        check = static_cast<uint64_t>(id[17] - '0');
+    } else if (id[17] == 'X' || id[17] == 'x') {
+        check = 10;
+    } else {
+        return kInvalidPackedId;
+    }
+    return value << 4 | check;
+}
+
+/**
+ * @brief Unpack an id into 18 characters.
+ *
+ * @param packed A packed id returned by pack_id().
+ * @param out The buffer receiving the 18 characters.
+ */
+constexpr void unpack_id(uint64_t packed, char *out) noexcept {
+    auto check = packed & 0xf;
+    out[17] = check == 10 ? 'X' : static_cast<char>('0' + check);
+    auto value = packed >> 4;
+    for (size_t i = 17; i-- > 0;) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+inline std::string unpack_id(uint64_t packed) {
+    std::string result(18, '0');
+    unpack_id(packed, result.data());
+    return result;
+}
+
+} // namespace idlib
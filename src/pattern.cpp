@@ -0,0 +1,24 @@
+#include "pattern.h"
+#include "details.h"
+
+namespace idlib {
+
+std::array<uint16_t, 8> pattern::date_masks() const noexcept {
+    std::array<uint16_t, 8> result{};
+    for (size_t i = 0; i < detail::kDateOfBirthLength; i++) {
+        result[i] = masks_[detail::kDateOfBirthStart + i];
+    }
+    return result;
+}
+
+size_t pattern::digits(size_t pos, char *out) const noexcept {
+    size_t count = 0;
+    for (int d = 0; d < 10; d++) {
+        if ((masks_[pos] >> d) & 1) {
+            out[count++] = static_cast<char>('0' + d);
+        }
+    }
+    return count;
+}
+
+} // namespace idlib
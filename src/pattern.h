@@ -0,0 +1,161 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "details.h"
+
+namespace idlib {
+
+/**
+ * @brief A compiled id template, each of the 18 positions is a set of allowed characters.
+ *
+ * Bit d of a position mask allows the digit d, bit 10 allows 'X' (check code only).
+ *
+ * Template syntax, one item per position:
+ * - a digit: only that digit
+ * - '*': any digit (any digit or 'X' for the check code)
+ * - 'm'/'M', 'f'/'F': odd/even digits, sequence code only
+ * - 'X'/'x': check code only
+ * - '[...]': a set of digits and ranges, like "[0-3]", "[13579]" or "[0-25X]"
+ */
+class pattern {
+
+    std::array<uint16_t, 18> masks_{};
+
+  public:
+    static constexpr uint16_t kDigits = 0x3ff;
+    static constexpr uint16_t kX = 0x400;
+    static constexpr uint16_t kOddDigits = 0x2aa;
+    static constexpr uint16_t kEvenDigits = 0x155;
+
+    /**
+     * @brief Compile a template.
+     *
+     * @param tmpl The template, like "11****19190810***0" or "11****19[0-3]*0810**m*".
+     * @throw std::invalid_argument if the template is malformed or does not have 18 positions.
+     * @throw std::invalid_argument if a position allows nothing.
+     */
+    constexpr explicit pattern(std::string_view tmpl) {
+        size_t pos = 0;
+        for (size_t i = 0; i < tmpl.size(); i++, pos++) {
+            if (pos >= 18) {
+                throw std::invalid_argument("The template must have exactly 18 positions.");
+            }
+            bool is_check_code = pos == detail::kCheckCodeIndex;
+            uint16_t any = is_check_code ? kDigits | kX : kDigits;
+            char c = tmpl[i];
+            uint16_t mask = 0;
+            if (c >= '0' && c <= '9') {
+                mask = static_cast<uint16_t>(1u << (c - '0'));
+            } else if (c == '*') {
+                mask = any;
+            } else if (pos == detail::kSequenceCodeIndex && (c == 'm' || c == 'M')) {
+                mask = kOddDigits;
+            } else if (pos == detail::kSequenceCodeIndex && (c == 'f' || c == 'F')) {
+                mask = kEvenDigits;
+            } else if (is_check_code && (c == 'X' || c == 'x')) {
+                mask = kX;
+            } else if (c == '[') {
+                auto close = tmpl.find(']', i);
+                if (close == std::string_view::npos) {
+                    throw std::invalid_argument("Unterminated '[' in the template.");
+                }
+                for (size_t j = i + 1; j < close; j++) {
+                    char from = tmpl[j];
+                    if (is_check_code && (from == 'X' || from == 'x')) {
+                        mask |= kX;
+                        continue;
+                    }
+                    char to = from;
+                    if (j + 2 < close && tmpl[j + 1] == '-') {
+                        to = tmpl[j + 2];
+                        j += 2;
+                    }
+                    if (from < '0' || from > '9' || to < '0' || to > '9' || from > to) {
+                        throw std::invalid_argument("A set in the template must only contain digits and ranges.");
+                    }
+                    for (char d = from; d <= to; d++) {
+                        mask |= static_cast<uint16_t>(1u << (d - '0'));
+                    }
+                }
+                i = close;
+            } else if (pos == detail::kSequenceCodeIndex) {
+                throw std::invalid_argument("The sequence code must be a digit, 'm'/'M', 'f'/'F', '*' or a set.");
+            } else if (is_check_code) {
+                throw std::invalid_argument("The check code must be a digit, 'X'/'x', '*' or a set.");
+            } else {
+                throw std::invalid_argument("The template must only contain digits, '*' and sets.");
+            }
+            if (mask == 0) {
+                throw std::invalid_argument("A position of the template allows nothing.");
+            }
+            masks_[pos] = mask;
+        }
+        if (pos != 18) {
+            throw std::invalid_argument("The template must have exactly 18 positions.");
+        }
+    }
+
+    /**
+     * @brief Construct a pattern from raw position masks.
+     */
+    constexpr explicit pattern(const std::array<uint16_t, 18> &masks) noexcept : masks_(masks) {}
+
+    [[nodiscard]] constexpr const std::array<uint16_t, 18> &masks() const noexcept { return masks_; }
+
+    [[nodiscard]] constexpr uint16_t mask(size_t pos) const noexcept { return masks_[pos]; }
+
+    /**
+     * @brief Check if a character is allowed at a position.
+     */
+    [[nodiscard]] constexpr bool allows(size_t pos, char c) const noexcept {
+        if (c >= '0' && c <= '9') {
+            return (masks_[pos] >> (c - '0')) & 1;
+        }
+        return (c == 'X' || c == 'x') && (masks_[pos] & kX);
+    }
+
+    /**
+     * @brief Check if the positions [start, start + str.size()) allow str.
+     */
+    [[nodiscard]] constexpr bool match(std::string_view str, size_t start = 0) const noexcept {
+        for (size_t i = 0; i < str.size(); i++) {
+            if (!allows(start + i, str[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check if every position of the pattern is a single digit or 'X'.
+     */
+    [[nodiscard]] constexpr bool is_fixed(size_t start = 0, size_t end = 18) const noexcept {
+        for (size_t i = start; i < end; i++) {
+            if (masks_[i] == 0 || (masks_[i] & (masks_[i] - 1)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the masks of the date of birth positions.
+     */
+    [[nodiscard]] std::array<uint16_t, 8> date_masks() const noexcept;
+
+    /**
+     * @brief Get the allowed digits of a position in ascending order.
+     *
+     * @param pos The position.
+     * @param out The buffer receiving up to 10 digits as characters ('X' is not included).
+     * @return size_t The number of digits written.
+     */
+    size_t digits(size_t pos, char *out) const noexcept;
+
+    constexpr bool operator==(const pattern &) const noexcept = default;
+};
+
+} // namespace idlib
@@ -0,0 +1,573 @@
+#include "pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IDLIB_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace idlib {
+
+namespace {
+
+// Bytes read past the end of a chunk so that the last line starting in it can be completed.
+constexpr size_t kLineOverlap = 4096;
+
+class file_handle {
+
+    int fd_ = -1;
+
+  public:
+    file_handle(const std::string &path, int flags) {
+#if defined(_WIN32)
+        fd_ = ::_open(path.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        fd_ = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+#endif
+        if (fd_ < 0) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+    }
+
+    file_handle(const file_handle &) = delete;
+    file_handle &operator=(const file_handle &) = delete;
+
+    ~file_handle() {
+#if defined(_WIN32)
+        ::_close(fd_);
+#else
+        ::close(fd_);
+#endif
+    }
+
+    [[nodiscard]] int get() const noexcept { return fd_; }
+
+    [[nodiscard]] uint64_t size() const {
+#if defined(_WIN32)
+        struct _stat64 st {};
+        if (::_fstat64(fd_, &st) != 0) {
+#else
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+#endif
+            throw std::runtime_error("Failed to get the size of the input file.");
+        }
+        return static_cast<uint64_t>(st.st_size);
+    }
+};
+
+// Reads or writes until len bytes are transferred or the end of the file, returns the count or -errno.
+int64_t transfer_at(bool write, int fd, char *buf, size_t len, uint64_t offset) noexcept {
+    size_t done = 0;
+    while (done < len) {
+#if defined(_WIN32)
+        // Only the I/O thread touches the file descriptors, so seeking first is safe.
+        if (::_lseeki64(fd, static_cast<int64_t>(offset + done), SEEK_SET) < 0) {
+            return -errno;
+        }
+        auto chunk = static_cast<unsigned>(std::min<size_t>(len - done, 1u << 30));
+        auto n = write ? ::_write(fd, buf + done, chunk) : ::_read(fd, buf + done, chunk);
+#else
+        auto n = write ? ::pwrite(fd, buf + done, len - done, static_cast<off_t>(offset + done))
+                       : ::pread(fd, buf + done, len - done, static_cast<off_t>(offset + done));
+#endif
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<int64_t>(done);
+}
+
+struct completion {
+    uint64_t user_data;
+    int64_t result; // bytes transferred or -errno
+};
+
+// Performs the queued requests synchronously when asked for completions.
+class sync_backend {
+
+    struct request {
+        bool write;
+        int fd;
+        char *buf;
+        size_t len;
+        uint64_t offset;
+        uint64_t user_data;
+    };
+
+    std::vector<request> pending_{};
+
+  public:
+    static constexpr bool kIoUring = false;
+
+    void read(int fd, char *buf, size_t len, uint64_t offset, uint64_t user_data) {
+        pending_.push_back({false, fd, buf, len, offset, user_data});
+    }
+
+    void write(int fd, const char *buf, size_t len, uint64_t offset, uint64_t user_data) {
+        pending_.push_back({true, fd, const_cast<char *>(buf), len, offset, user_data});
+    }
+
+    void wait(std::vector<completion> &out) {
+        out.clear();
+        for (auto &r : pending_) {
+            out.push_back({r.user_data, transfer_at(r.write, r.fd, r.buf, r.len, r.offset)});
+        }
+        pending_.clear();
+    }
+};
+
+#if defined(IDLIB_HAS_IO_URING)
+
+// A minimal io_uring driven through the raw system calls, so no liburing is needed.
+class uring_backend {
+
+    int ring_fd_ = -1;
+    void *sq_ring_ = MAP_FAILED;
+    size_t sq_ring_size_{};
+    void *cq_ring_ = MAP_FAILED;
+    size_t cq_ring_size_{};
+    io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqes_size_{};
+    unsigned *sq_tail_{};
+    unsigned sq_mask_{};
+    unsigned *sq_array_{};
+    unsigned *cq_head_{};
+    unsigned *cq_tail_{};
+    unsigned cq_mask_{};
+    io_uring_cqe *cqes_{};
+    unsigned to_submit_{};
+    std::vector<iovec> iovecs_{};
+
+    void push(uint8_t opcode, int fd, char *buf, size_t len, uint64_t offset, uint64_t user_data) {
+        // The iovec must stay alive until the request completes, there is one per user_data (buffer).
+        iovecs_[user_data] = {buf, len};
+        auto tail = *sq_tail_;
+        auto index = tail & sq_mask_;
+        auto &sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(&iovecs_[user_data]);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+        ++to_submit_;
+    }
+
+    void close() noexcept {
+        if (sqes_ != MAP_FAILED) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != MAP_FAILED) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+        }
+    }
+
+  public:
+    static constexpr bool kIoUring = true;
+
+    /**
+     * @throw std::runtime_error if io_uring is not available (old kernel, seccomp, ...).
+     */
+    explicit uring_backend(unsigned entries) : iovecs_(entries) {
+        io_uring_params params{};
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, std::bit_ceil(entries), &params));
+        if (ring_fd_ < 0) {
+            throw std::runtime_error("io_uring is not available.");
+        }
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                          IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            close();
+            throw std::runtime_error("Failed to map the io_uring submission queue.");
+        }
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                              IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED) {
+                close();
+                throw std::runtime_error("Failed to map the io_uring completion queue.");
+            }
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) {
+            close();
+            throw std::runtime_error("Failed to map the io_uring submission entries.");
+        }
+        auto sq = static_cast<char *>(sq_ring_);
+        auto cq = static_cast<char *>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    uring_backend(const uring_backend &) = delete;
+    uring_backend &operator=(const uring_backend &) = delete;
+
+    ~uring_backend() { close(); }
+
+    void read(int fd, char *buf, size_t len, uint64_t offset, uint64_t user_data) {
+        push(IORING_OP_READV, fd, buf, len, offset, user_data);
+    }
+
+    void write(int fd, const char *buf, size_t len, uint64_t offset, uint64_t user_data) {
+        push(IORING_OP_WRITEV, fd, const_cast<char *>(buf), len, offset, user_data);
+    }
+
+    void wait(std::vector<completion> &out) {
+        out.clear();
+        while (true) {
+            auto head = *cq_head_;
+            auto tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+            for (; head != tail; ++head) {
+                auto &cqe = cqes_[head & cq_mask_];
+                out.push_back({cqe.user_data, cqe.res});
+            }
+            std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+            if (!out.empty() && to_submit_ == 0) {
+                return;
+            }
+            auto ret = ::syscall(__NR_io_uring_enter, ring_fd_, to_submit_, out.empty() ? 1 : 0,
+                                 out.empty() ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (ret < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+            }
+            to_submit_ -= static_cast<unsigned>(ret);
+        }
+    }
+};
+
+#endif
+
+template <typename T> class blocking_queue {
+
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+    std::deque<T> items_{};
+    bool closed_{};
+
+  public:
+    void push(T item) {
+        {
+            std::lock_guard lock(mutex_);
+            items_.push_back(std::move(item));
+        }
+        cv_.notify_one();
+    }
+
+    // Returns false once the queue is closed and empty.
+    bool pop(T &item) {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+
+    bool try_pop(T &item) {
+        std::lock_guard lock(mutex_);
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+};
+
+struct chunk {
+    std::vector<char> in;
+    size_t in_size{};
+    size_t in_done{};
+    std::vector<char> out;
+    size_t out_size{};
+    size_t out_done{};
+    uint64_t seq{};
+    uint64_t read_start{};
+    uint64_t begin{}; // [begin, end) is the part of the file whose lines start in this chunk
+    uint64_t end{};
+    uint64_t write_offset{};
+    bool writing{};
+    pipeline_stats stats{};
+};
+
+void process(chunk &c, const pipeline_options &options) {
+    c.stats = {};
+    c.out_size = 0;
+    const char *data = c.in.data();
+    auto size = c.in_size;
+    auto end = static_cast<size_t>(c.end - c.read_start);
+    size_t pos = 0;
+    if (c.begin != 0) {
+        // The buffer starts one byte early, the line running into the chunk belongs to the previous one.
+        auto newline = static_cast<const char *>(std::memchr(data, '\n', size));
+        if (!newline) {
+            return;
+        }
+        pos = static_cast<size_t>(newline - data) + 1;
+    }
+    while (pos < end && pos < size) {
+        auto newline = static_cast<const char *>(std::memchr(data + pos, '\n', size - pos));
+        auto line_end = newline ? static_cast<size_t>(newline - data) : size;
+        std::string_view line(data + pos, line_end - pos);
+        pos = line_end + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        ++c.stats.lines;
+        auto id = validator::decode(line, options.valid_date_range);
+        if (!id.ok()) {
+            ++c.stats.errors[static_cast<size_t>(id.error)];
+            continue;
+        }
+        ++c.stats.valid;
+        std::memcpy(c.out.data() + c.out_size, line.data(), line.size());
+        c.out_size += line.size();
+        c.out[c.out_size++] = '\n';
+    }
+}
+
+template <typename Backend>
+pipeline_stats run(Backend &io, int in_fd, uint64_t in_size, int out_fd, const pipeline_options &options) {
+    auto buffer_size = static_cast<uint64_t>(options.buffer_size);
+    std::vector<chunk> chunks(options.queue_depth);
+    std::vector<size_t> free_chunks;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        chunks[i].in.resize(options.buffer_size + kLineOverlap + 1);
+        chunks[i].out.resize(options.buffer_size + kLineOverlap + 2);
+        free_chunks.push_back(i);
+    }
+
+    blocking_queue<size_t> ready;
+    blocking_queue<size_t> done;
+    auto threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::jthread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back([&] {
+            size_t index;
+            while (ready.pop(index)) {
+                process(chunks[index], options);
+                done.push(index);
+            }
+        });
+    }
+    struct stop_workers {
+        blocking_queue<size_t> &ready;
+        ~stop_workers() { ready.close(); }
+    } stop{ready};
+
+    pipeline_stats stats{};
+    stats.used_io_uring = Backend::kIoUring;
+    uint64_t next_offset = 0;
+    uint64_t next_seq = 0;
+    uint64_t next_write_seq = 0;
+    uint64_t write_offset = 0;
+    size_t in_flight = 0;
+    size_t processing = 0;
+    std::map<uint64_t, size_t> processed;
+    std::vector<completion> completions;
+    std::string error;
+
+    auto collect = [&](size_t index) {
+        --processing;
+        auto &c = chunks[index];
+        stats.lines += c.stats.lines;
+        stats.valid += c.stats.valid;
+        for (size_t i = 0; i < kIdErrorCount; i++) {
+            stats.errors[i] += c.stats.errors[i];
+        }
+        processed.emplace(c.seq, index);
+    };
+
+    while (true) {
+        while (error.empty() && !free_chunks.empty() && next_offset < in_size) {
+            auto index = free_chunks.back();
+            free_chunks.pop_back();
+            auto &c = chunks[index];
+            c.seq = next_seq++;
+            c.begin = next_offset;
+            c.end = std::min(next_offset + buffer_size, in_size);
+            c.read_start = c.begin == 0 ? 0 : c.begin - 1;
+            c.in_size = static_cast<size_t>(std::min(c.end + kLineOverlap, in_size) - c.read_start);
+            c.in_done = 0;
+            c.writing = false;
+            io.read(in_fd, c.in.data(), c.in_size, c.read_start, index);
+            ++in_flight;
+            next_offset = c.end;
+        }
+
+        size_t index;
+        while (done.try_pop(index)) {
+            collect(index);
+        }
+        while (error.empty() && !processed.empty() && processed.begin()->first == next_write_seq) {
+            index = processed.begin()->second;
+            processed.erase(processed.begin());
+            ++next_write_seq;
+            auto &c = chunks[index];
+            if (c.out_size == 0) {
+                free_chunks.push_back(index);
+                continue;
+            }
+            c.writing = true;
+            c.out_done = 0;
+            c.write_offset = write_offset;
+            write_offset += c.out_size;
+            io.write(out_fd, c.out.data(), c.out_size, c.write_offset, index);
+            ++in_flight;
+        }
+
+        if (in_flight == 0) {
+            if (processing != 0) {
+                // Nothing to wait for but the workers.
+                if (done.pop(index)) {
+                    collect(index);
+                }
+                continue;
+            }
+            if (!error.empty() || (next_offset >= in_size && processed.empty())) {
+                break;
+            }
+            continue;
+        }
+
+        io.wait(completions);
+        for (auto &completion : completions) {
+            --in_flight;
+            index = static_cast<size_t>(completion.user_data);
+            auto &c = chunks[index];
+            if (completion.result < 0) {
+                if (error.empty()) {
+                    error = std::string(c.writing ? "Failed to write: " : "Failed to read: ") +
+                            std::strerror(static_cast<int>(-completion.result));
+                }
+                continue;
+            }
+            if (!c.writing) {
+                // A short read is resubmitted for the rest, until the chunk is full or the file ends.
+                c.in_done += static_cast<size_t>(completion.result);
+                if (c.in_done < c.in_size && completion.result > 0 && error.empty()) {
+                    io.read(in_fd, c.in.data() + c.in_done, c.in_size - c.in_done, c.read_start + c.in_done, index);
+                    ++in_flight;
+                    continue;
+                }
+                c.in_size = c.in_done;
+                ready.push(index);
+                ++processing;
+                continue;
+            }
+            c.out_done += static_cast<size_t>(completion.result);
+            if (c.out_done < c.out_size && completion.result > 0 && error.empty()) {
+                io.write(out_fd, c.out.data() + c.out_done, c.out_size - c.out_done, c.write_offset + c.out_done,
+                         index);
+                ++in_flight;
+            } else if (c.out_done < c.out_size && error.empty()) {
+                error = "Failed to write: no progress.";
+            } else {
+                free_chunks.push_back(index);
+            }
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    return stats;
+}
+
+} // namespace
+
+pipeline_stats validate_file(const std::string &input, const std::string &output, const pipeline_options &options) {
+    if (options.queue_depth == 0 || options.buffer_size == 0) {
+        throw std::invalid_argument("The queue depth and the buffer size must be positive.");
+    }
+    file_handle in(input, O_RDONLY);
+    file_handle out(output, O_WRONLY | O_CREAT | O_TRUNC);
+    auto in_size = in.size();
+#if defined(IDLIB_HAS_IO_URING)
+    if (options.use_io_uring) {
+        std::unique_ptr<uring_backend> io;
+        try {
+            io = std::make_unique<uring_backend>(static_cast<unsigned>(options.queue_depth));
+        } catch (const std::runtime_error &) {
+        }
+        if (io) {
+            return run(*io, in.get(), in_size, out.get(), options);
+        }
+    }
+#endif
+    sync_backend io;
+    return run(io, in.get(), in_size, out.get(), options);
+}
+
+} // namespace idlib
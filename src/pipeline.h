@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "validator.h"
+
+namespace idlib {
+
+struct pipeline_options {
+    size_t queue_depth = 8;       // number of buffers in flight between reading, validating and writing
+    size_t buffer_size = 1 << 20; // bytes read per buffer
+    unsigned threads = 0;         // validating threads, 0 for std::thread::hardware_concurrency()
+    bool use_io_uring = true;     // falls back to pread/pwrite if io_uring is unavailable
+    std::pair<std::chrono::year_month_day, std::chrono::year_month_day> valid_date_range{};
+};
+
+struct pipeline_stats {
+    uint64_t lines{};
+    uint64_t valid{};
+    std::array<uint64_t, kIdErrorCount> errors{}; // indexed by id_error
+    bool used_io_uring{};
+};
+
+/**
+ * @brief Validate a file of ids, one per line, and write the valid lines to another file.
+ *
+ * The file is read in chunks which are validated by worker threads while further reads and the writes of earlier
+ * chunks are in flight. On Linux the reads and writes go through io_uring, elsewhere (or if io_uring cannot be set
+ * up) a plain pread/pwrite loop on the calling thread is used. The output keeps the order of the input, empty lines
+ * are skipped and a line longer than 4 KiB may be cut where it crosses a chunk boundary.
+ *
+ * @param input The path of the input file.
+ * @param output The path of the output file, truncated if it exists.
+ * @param options The pipeline options.
+ * @return pipeline_stats The number of lines and the failures by category.
+ * @throw std::runtime_error if a file cannot be opened, read or written.
+ * @throw std::invalid_argument if queue_depth or buffer_size is 0.
+ */
+pipeline_stats validate_file(const std::string &input, const std::string &output,
+                             const pipeline_options &options = {});
+
+} // namespace idlib
@@ -0,0 +1,196 @@
+#include "prefix-validator.h"
+#include "calendar.h"
+#include "details.h"
+#include "mod11-2.h"
+#include "pattern.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <vector>
+
+namespace idlib {
+
+namespace {
+
+// A node of the region code trie, its children are stored contiguously in digit order.
+struct trie_node {
+    uint16_t digits; // bit d is set if the digit d has a child
+    uint16_t first;  // the index of the first child
+};
+
+// The trie is stored level by level, since the region codes are sorted the children of a node are contiguous.
+const std::vector<trie_node> &region_trie() {
+    static const auto trie = [] {
+        std::vector<trie_node> nodes(1);
+        std::vector<uint16_t> parents(detail::kRegionCodeCount);
+        for (size_t depth = 0; depth < detail::kRegionCodeLength; depth++) {
+            std::string_view previous;
+            uint16_t current = 0;
+            for (size_t i = 0; i < detail::kRegionCodeCount; i++) {
+                auto prefix = kRegionCodes[i].substr(0, depth + 1);
+                if (prefix != previous) {
+                    current = static_cast<uint16_t>(nodes.size());
+                    auto &parent = nodes[parents[i]];
+                    if (parent.digits == 0) {
+                        parent.first = current;
+                    }
+                    parent.digits |= static_cast<uint16_t>(1u << (prefix[depth] - '0'));
+                    nodes.push_back({});
+                    previous = prefix;
+                }
+                parents[i] = current;
+            }
+        }
+        return nodes;
+    }();
+    return trie;
+}
+
+constexpr uint32_t pack(const std::chrono::year_month_day &ymd) {
+    return static_cast<uint32_t>(static_cast<int>(ymd.year())) * 10000 + static_cast<unsigned>(ymd.month()) * 100 +
+           static_cast<unsigned>(ymd.day());
+}
+
+// The first valid date packed as yyyymmdd that is not less than date.
+constexpr uint32_t next_valid_date(uint32_t date) {
+    auto y = date / 10000;
+    auto m = date / 100 % 100;
+    auto d = date % 100;
+    if (m == 0) {
+        m = d = 1;
+    } else if (m > 12) {
+        ++y;
+        m = d = 1;
+    } else if (d == 0) {
+        d = 1;
+    } else if (d > detail::last_day_of_month(static_cast<int>(y), m)) {
+        d = 1;
+        if (++m > 12) {
+            ++y;
+            m = 1;
+        }
+    }
+    return y * 10000 + m * 100 + d;
+}
+
+constexpr uint32_t kPowersOf10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+} // namespace
+
+prefix_validator::prefix_validator(
+    const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range)
+    : date_first_(valid_date_range.first.ok() ? pack(valid_date_range.first) : 101),
+      date_last_(valid_date_range.second.ok() ? pack(valid_date_range.second) : 99991231) {
+    if (date_first_ > date_last_) {
+        throw std::invalid_argument("The start date must not be later than the end date.");
+    }
+    region_trie();
+}
+
+uint32_t prefix_validator::date_prefix() const noexcept {
+    uint32_t date = 0;
+    for (size_t i = detail::kDateOfBirthStart; i < std::min(size_, detail::kDateOfBirthEnd); i++) {
+        date = date * 10 + static_cast<uint32_t>(id_[i] - '0');
+    }
+    return date;
+}
+
+bool prefix_validator::date_viable(uint32_t prefix, size_t digits) const noexcept {
+    // The completions of the prefix are the numbers in [first, last], look for the first valid date among them.
+    auto scale = kPowersOf10[detail::kDateOfBirthLength - digits];
+    auto first = std::max(prefix * scale, date_first_);
+    auto last = std::min(prefix * scale + scale - 1, date_last_);
+    return first <= last && next_valid_date(first) <= last;
+}
+
+id_error prefix_validator::push(char c) noexcept {
+    auto pos = size_++;
+    if (pos < id_.size()) {
+        id_[pos] = c;
+    }
+    if (error_ != id_error::kNone) {
+        return error_;
+    }
+    auto fail = [&](id_error error) {
+        error_ = error;
+        error_position_ = pos;
+        return error;
+    };
+    if (pos >= id_.size()) {
+        return fail(id_error::kLength);
+    }
+    if (pos == detail::kCheckCodeIndex) {
+        if (c == 'x') {
+            c = 'X';
+        }
+        if ((c < '0' || c > '9') && c != 'X') {
+            return fail(id_error::kCharacter);
+        }
+        return c == mod11_2::kCheckDigits[sums_[pos] % 11] ? id_error::kNone : fail(id_error::kCheckCode);
+    }
+    auto digit = static_cast<unsigned>(c - '0');
+    if (digit > 9) {
+        return fail(id_error::kCharacter);
+    }
+    sums_[pos + 1] = sums_[pos] + static_cast<int>(digit) * mod11_2::kFactors[pos];
+
+    if (pos < detail::kRegionCodeEnd) {
+        auto &node = region_trie()[nodes_[pos]];
+        if (!((node.digits >> digit) & 1)) {
+            return fail(id_error::kRegionCode);
+        }
+        nodes_[pos + 1] = static_cast<uint16_t>(node.first + std::popcount(node.digits & ((1u << digit) - 1)));
+    } else if (pos < detail::kDateOfBirthEnd && !date_viable(date_prefix(), size_ - detail::kDateOfBirthStart)) {
+        return fail(id_error::kDateOfBirth);
+    }
+    return id_error::kNone;
+}
+
+void prefix_validator::pop() noexcept {
+    if (size_ == 0) {
+        return;
+    }
+    --size_;
+    if (error_ != id_error::kNone && size_ <= error_position_) {
+        error_ = id_error::kNone;
+    }
+}
+
+void prefix_validator::clear() noexcept {
+    size_ = 0;
+    error_ = id_error::kNone;
+}
+
+id_error prefix_validator::assign(std::string_view prefix) noexcept {
+    clear();
+    for (auto c : prefix) {
+        push(c);
+    }
+    return error_;
+}
+
+uint16_t prefix_validator::next() const noexcept {
+    if (error_ != id_error::kNone || size_ >= id_.size()) {
+        return 0;
+    }
+    if (size_ < detail::kRegionCodeEnd) {
+        return region_trie()[nodes_[size_]].digits;
+    }
+    if (size_ < detail::kDateOfBirthEnd) {
+        uint16_t digits = 0;
+        auto prefix = date_prefix();
+        auto length = size_ - detail::kDateOfBirthStart + 1;
+        for (uint32_t d = 0; d < 10; d++) {
+            digits |= static_cast<uint16_t>(date_viable(prefix * 10 + d, length) << d);
+        }
+        return digits;
+    }
+    if (size_ < detail::kCheckCodeIndex) {
+        return 0x3ff;
+    }
+    auto check = mod11_2::kCheckInts[sums_[size_] % 11];
+    return check == 10 ? pattern::kX : static_cast<uint16_t>(1u << check);
+}
+
+} // namespace idlib
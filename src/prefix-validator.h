@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "validator.h"
+
+namespace idlib {
+
+/**
+ * @brief Validates an id as it is typed, one character at a time.
+ *
+ * After every character it tells whether the prefix can still be completed to a valid id and which characters can
+ * come next, so a form can reject a keystroke or hint at the field being typed instead of failing on the length.
+ * The region code is followed down a trie of the region codes, the date of birth is checked against the calendar
+ * and the valid date range, and the weighted sum of the check code is kept running, so push(), pop() and next() are
+ * O(1) regardless of the length of the prefix.
+ *
+ * The fields are independent, so a prefix is viable as long as every field typed so far has a valid completion.
+ */
+class prefix_validator {
+
+    std::array<char, 18> id_{};
+    size_t size_{};
+    id_error error_{id_error::kNone};
+    size_t error_position_{};
+    std::array<uint16_t, 7> nodes_{}; // nodes_[i] is the trie node after i characters of the region code
+    std::array<int, 18> sums_{};      // sums_[i] is the weighted sum of the first i digits
+    uint32_t date_first_{};           // the valid date range packed as yyyymmdd
+    uint32_t date_last_{};
+
+    [[nodiscard]] uint32_t date_prefix() const noexcept;
+    [[nodiscard]] bool date_viable(uint32_t prefix, size_t digits) const noexcept;
+
+  public:
+    /**
+     * @brief Construct a new prefix_validator object.
+     *
+     * @param valid_date_range The valid date range of the date of birth, bounds that are not ok() are ignored.
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    explicit prefix_validator(
+        const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range = {});
+
+    /**
+     * @brief Append a character.
+     *
+     * A character that makes the prefix unviable is still appended, so that pop() undoes it like a backspace.
+     *
+     * @return id_error The first error of the prefix, kNone if it can still be completed.
+     */
+    id_error push(char c) noexcept;
+
+    /**
+     * @brief Remove the last character, if any.
+     */
+    void pop() noexcept;
+
+    void clear() noexcept;
+
+    /**
+     * @brief Replace the prefix, e.g. after a paste.
+     *
+     * @return id_error The first error of the prefix, kNone if it can still be completed.
+     */
+    id_error assign(std::string_view prefix) noexcept;
+
+    /**
+     * @brief The characters that keep the prefix viable when appended.
+     *
+     * @return uint16_t Bit d is set if the digit d is viable, bit 10 if 'X' is. 0 once the prefix is unviable or
+     * complete.
+     */
+    [[nodiscard]] uint16_t next() const noexcept;
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+    /**
+     * @brief The prefix typed so far, without the characters beyond the 18th.
+     */
+    [[nodiscard]] std::string_view prefix() const noexcept { return {id_.data(), size_ < 18 ? size_ : 18}; }
+
+    [[nodiscard]] bool viable() const noexcept { return error_ == id_error::kNone; }
+
+    /**
+     * @brief Whether the prefix is a complete, valid id.
+     */
+    [[nodiscard]] bool complete() const noexcept { return viable() && size_ == 18; }
+
+    [[nodiscard]] id_error error() const noexcept { return error_; }
+
+    /**
+     * @brief The position of the character that made the prefix unviable, only meaningful if !viable().
+     */
+    [[nodiscard]] size_t error_position() const noexcept { return error_position_; }
+};
+
+} // namespace idlib
@@ -0,0 +1,120 @@
+#include "pseudonymizer.h"
+#include "calendar.h"
+#include "exhaustor.h"
+#include "mod11-2.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace idlib {
+
+namespace {
+
+// Each of the 1000 registry and sequence codes pairs up with the one of the other sex, the pair is permuted.
+constexpr unsigned kTailPairs = 500;
+
+template <typename Map>
+size_t map_records(std::span<const id_record> records, std::span<id_record> out, id_error *errors, Map &&map) {
+    if (out.size() < records.size()) {
+        throw std::invalid_argument("The output must have room for every record.");
+    }
+    size_t mapped = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        auto error = map(std::string_view(records[i].data(), records[i].size()), out[i].data());
+        if (error == id_error::kNone) {
+            ++mapped;
+        } else {
+            out[i].fill('0');
+        }
+        if (errors) {
+            errors[i] = error;
+        }
+    }
+    return mapped;
+}
+
+} // namespace
+
+id_pseudonymizer::id_pseudonymizer(const key_type &key, std::chrono::year_month_day start,
+                                   std::chrono::year_month_day end)
+    : date_range_(start, end), region_ranks_(detail::kRegionCodeCount) {
+    if (!start.ok() || !end.ok() || start > end) {
+        throw std::invalid_argument("The date range is invalid.");
+    }
+    if (end > exhaustor::today()) {
+        throw std::invalid_argument("The date range must not end after today.");
+    }
+    first_day_ = detail::to_day_serial(start);
+    days_ = static_cast<uint32_t>(detail::to_day_serial(end) - first_day_ + 1);
+    const auto &regions = detail::distinct_regions();
+    for (size_t rank = 0; rank < regions.size(); rank++) {
+        auto last = rank + 1 < regions.size() ? regions[rank + 1] : detail::kRegionCodeCount;
+        std::fill(region_ranks_.begin() + regions[rank], region_ranks_.begin() + last, static_cast<uint16_t>(rank));
+    }
+    permutation_ = detail::keyed_feistel_permutation(regions.size() * days_ * kTailPairs, key);
+}
+
+id_error id_pseudonymizer::map(std::string_view id, char *out, bool forward) const noexcept {
+    auto decoded = validator::decode(id, date_range_);
+    if (!decoded.ok()) {
+        return decoded.error;
+    }
+    auto day = detail::days_from_civil(decoded.year(), decoded.month(), decoded.day()) - first_day_;
+    auto tail = static_cast<unsigned>(id[14] - '0') * 100 + static_cast<unsigned>(id[15] - '0') * 10 +
+                static_cast<unsigned>(id[16] - '0');
+    uint64_t value = (static_cast<uint64_t>(region_ranks_[decoded.region_index]) * days_ + day) * kTailPairs + tail / 2;
+    value = forward ? permutation_(value) : permutation_.inverse(value);
+
+    tail = static_cast<unsigned>(value % kTailPairs) * 2 + (tail & 1);
+    value /= kTailPairs;
+    auto region = kRegionCodes[detail::distinct_regions()[value / days_]];
+    auto ymd = detail::from_day_serial(first_day_ + static_cast<int32_t>(value % days_));
+    auto date = static_cast<unsigned>(static_cast<int>(ymd.year()) * 10000 + static_cast<unsigned>(ymd.month()) * 100 +
+                                      static_cast<unsigned>(ymd.day()));
+
+    std::copy(region.begin(), region.end(), out);
+    for (int k = 13; k >= 6; k--, date /= 10) {
+        out[k] = static_cast<char>('0' + date % 10);
+    }
+    for (int k = 16; k >= 14; k--, tail /= 10) {
+        out[k] = static_cast<char>('0' + tail % 10);
+    }
+    out[17] = mod11_2::kCheckDigits[mod11_2::weighted_sum({out, 17}) % 11];
+    return id_error::kNone;
+}
+
+id_error id_pseudonymizer::pseudonymize(std::string_view id, char *out) const noexcept {
+    return map(id, out, true);
+}
+
+std::string id_pseudonymizer::pseudonymize(std::string_view id) const {
+    std::string result(18, '\0');
+    if (map(id, result.data(), true) != id_error::kNone) {
+        throw std::invalid_argument("The id is invalid or outside of the date range.");
+    }
+    return result;
+}
+
+id_error id_pseudonymizer::restore(std::string_view pseudonym, char *out) const noexcept {
+    return map(pseudonym, out, false);
+}
+
+std::string id_pseudonymizer::restore(std::string_view pseudonym) const {
+    std::string result(18, '\0');
+    if (map(pseudonym, result.data(), false) != id_error::kNone) {
+        throw std::invalid_argument("The pseudonym is invalid or outside of the date range.");
+    }
+    return result;
+}
+
+size_t id_pseudonymizer::pseudonymize(std::span<const id_record> records, std::span<id_record> out,
+                                      id_error *errors) const {
+    return map_records(records, out, errors, [&](std::string_view id, char *o) { return map(id, o, true); });
+}
+
+size_t id_pseudonymizer::restore(std::span<const id_record> records, std::span<id_record> out,
+                                 id_error *errors) const {
+    return map_records(records, out, errors, [&](std::string_view id, char *o) { return map(id, o, false); });
+}
+
+} // namespace idlib
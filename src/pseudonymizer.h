@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "details.h"
+#include "feistel.h"
+#include "validator.h"
+
+namespace idlib {
+
+/**
+ * @brief Replaces valid ids with other valid ids under a key, for masking production data copied to test systems.
+ *
+ * The region code, the date of birth as a day serial and the registry and sequence codes of an id are packed into
+ * one number in the space of all valid ids, which a keyed permutation maps to another valid id whose check code is
+ * recomputed with mod 11-2. The same key and date range always give the same mapping, so joins across tables still
+ * line up, and restore() maps a pseudonym back for whoever holds the key. The parity of the sequence code is kept,
+ * so the pseudonym has the same sex as the id. Every field is mixed with the others, a region code doesn't always map
+ * to the same region code. Pseudonyms are born within the date range, which therefore can't end after today.
+ *
+ * The permutation is a format-preserving cipher in the style of FF1: an unbalanced Feistel network of 10 rounds with
+ * SipHash-2-4 under a 128-bit key as its round function. Use a random key and keep it secret, anyone holding it can
+ * restore every id. The space of valid ids is small (about 2^36 for a century), so a pseudonym alone doesn't hide
+ * an id that an attacker can confirm by other means, e.g. a known pair of id and pseudonym for a guessed person.
+ */
+class id_pseudonymizer {
+
+    detail::keyed_feistel_permutation permutation_{};
+    std::pair<std::chrono::year_month_day, std::chrono::year_month_day> date_range_{};
+    int32_t first_day_{};
+    uint32_t days_{};
+    std::vector<uint16_t> region_ranks_{}; // the rank among the distinct region codes of each index of kRegionCodes
+
+    id_error map(std::string_view id, char *out, bool forward) const noexcept;
+
+  public:
+    using key_type = std::array<uint8_t, 16>;
+
+    /**
+     * @brief Construct a new id_pseudonymizer object.
+     *
+     * The range is explicit rather than ending today, a default that moves would change the mapping from one day to
+     * the next.
+     *
+     * @param key The 128-bit key, the same key and date range give the same mapping.
+     * @param start The first date of birth of the ids and their pseudonyms.
+     * @param end The last date of birth of the ids and their pseudonyms, not after today.
+     * @throw std::invalid_argument if the dates are invalid, start is after end or end is after today.
+     */
+    id_pseudonymizer(const key_type &key, std::chrono::year_month_day start, std::chrono::year_month_day end);
+
+    /**
+     * @brief Map a valid id to its pseudonym.
+     *
+     * @param out Receives the 18 characters of the pseudonym if the id is valid, no null terminator is written.
+     * @return id_error kNone, or the first error of the id, kDateOfBirth if it is outside of the date range.
+     */
+    id_error pseudonymize(std::string_view id, char *out) const noexcept;
+
+    /**
+     * @brief Map a valid id to its pseudonym.
+     *
+     * @throw std::invalid_argument if the id is invalid or its date of birth is outside of the date range.
+     */
+    [[nodiscard]] std::string pseudonymize(std::string_view id) const;
+
+    /**
+     * @brief Map a pseudonym back to the id, the inverse of pseudonymize().
+     *
+     * @return id_error kNone, or the first error of the pseudonym.
+     */
+    id_error restore(std::string_view pseudonym, char *out) const noexcept;
+
+    /**
+     * @brief Map a pseudonym back to the id.
+     *
+     * @throw std::invalid_argument if the pseudonym is invalid or its date of birth is outside of the date range.
+     */
+    [[nodiscard]] std::string restore(std::string_view pseudonym) const;
+
+    /**
+     * @brief Pseudonymize ids in a batch.
+     *
+     * @param records The ids.
+     * @param out Receives the pseudonyms, out[i] is all '0' if records[i] is invalid so no real id leaks through.
+     * @param errors If not null, errors[i] is set to the first error of records[i].
+     * @return size_t The number of ids that were pseudonymized.
+     * @throw std::invalid_argument if out is smaller than records.
+     */
+    size_t pseudonymize(std::span<const id_record> records, std::span<id_record> out,
+                        id_error *errors = nullptr) const;
+
+    /**
+     * @brief Restore pseudonyms in a batch, see pseudonymize().
+     */
+    size_t restore(std::span<const id_record> records, std::span<id_record> out, id_error *errors = nullptr) const;
+};
+
+} // namespace idlib
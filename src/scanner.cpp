@@ -0,0 +1,156 @@
+#include "scanner.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace idlib {
+
+namespace {
+
+constexpr size_t kIdLength = 18;
+constexpr size_t kBlock = 64;
+
+#if defined(__AVX2__)
+
+inline uint32_t word_mask32(const char *p) noexcept {
+    auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    auto digit = _mm256_sub_epi8(bytes, _mm256_set1_epi8('0'));
+    auto is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    auto letter = _mm256_sub_epi8(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    auto is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(25)), letter);
+    auto is_underscore = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_'));
+    auto is_word = _mm256_or_si256(_mm256_or_si256(is_digit, is_letter), is_underscore);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(is_word));
+}
+
+// Bit i is set if p[i] is a word character.
+inline uint64_t word_mask(const char *p) noexcept {
+    return word_mask32(p) | static_cast<uint64_t>(word_mask32(p + 32)) << 32;
+}
+
+#elif defined(__SSE2__)
+
+inline uint64_t word_mask16(const char *p) noexcept {
+    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    auto digit = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    auto letter = _mm_sub_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    auto is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(25)), letter);
+    auto is_underscore = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_'));
+    return static_cast<uint16_t>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(is_digit, is_letter), is_underscore)));
+}
+
+// Bit i is set if p[i] is a word character.
+inline uint64_t word_mask(const char *p) noexcept {
+    return word_mask16(p) | word_mask16(p + 16) << 16 | word_mask16(p + 32) << 32 | word_mask16(p + 48) << 48;
+}
+
+#else
+
+constexpr bool is_word(char c) noexcept {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// Bit i is set if p[i] is a word character.
+inline uint64_t word_mask(const char *p) noexcept {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < kBlock; i++) {
+        mask |= static_cast<uint64_t>(is_word(p[i])) << i;
+    }
+    return mask;
+}
+
+#endif
+
+} // namespace
+
+id_scanner::id_scanner(std::pair<std::chrono::year_month_day, std::chrono::year_month_day> valid_date_range) noexcept
+    : valid_date_range_(valid_date_range) {}
+
+void id_scanner::feed(std::string_view chunk, const callback &on_match) {
+    auto report = [&](const char *word) {
+        auto id = validator::decode({word, kIdLength}, valid_date_range_);
+        if (id.ok()) {
+            on_match({word_start_, id});
+        }
+    };
+    // Close the open word at stream offset end.
+    auto close = [&](uint64_t end) {
+        in_word_ = false;
+        if (end - word_start_ != kIdLength) {
+            return;
+        }
+        if (word_start_ >= offset_) {
+            report(chunk.data() + (word_start_ - offset_));
+            return;
+        }
+        // The word started in an earlier chunk, its head was saved in word_.
+        auto head = static_cast<size_t>(offset_ - word_start_);
+        std::memcpy(word_ + head, chunk.data(), kIdLength - head);
+        report(word_);
+    };
+
+    for (size_t base = 0; base < chunk.size(); base += kBlock) {
+        auto n = std::min(kBlock, chunk.size() - base);
+        uint64_t mask;
+        if (n == kBlock) {
+            mask = word_mask(chunk.data() + base);
+        } else {
+            char tail[kBlock]{};
+            std::memcpy(tail, chunk.data() + base, n);
+            mask = word_mask(tail);
+        }
+        // A bit is set where the word state changes, positions past the chunk don't change it.
+        auto events = (mask ^ (mask << 1 | static_cast<uint64_t>(in_word_))) & (n == kBlock ? ~0ULL : (1ULL << n) - 1);
+        while (events) {
+            auto pos = offset_ + base + static_cast<uint64_t>(std::countr_zero(events));
+            events &= events - 1;
+            if (in_word_) {
+                close(pos);
+            } else {
+                in_word_ = true;
+                word_start_ = pos;
+            }
+        }
+    }
+
+    // Save the head of a word that continues into the next chunk.
+    auto end = offset_ + chunk.size();
+    if (in_word_ && end - word_start_ <= kIdLength) {
+        auto saved = word_start_ >= offset_ ? 0 : static_cast<size_t>(offset_ - word_start_);
+        auto first = static_cast<size_t>(std::max(word_start_, offset_) - offset_);
+        std::memcpy(word_ + saved, chunk.data() + first, chunk.size() - first);
+    }
+    offset_ = end;
+}
+
+void id_scanner::finish(const callback &on_match) {
+    if (in_word_ && offset_ - word_start_ == kIdLength) {
+        auto id = validator::decode({word_, kIdLength}, valid_date_range_);
+        if (id.ok()) {
+            on_match({word_start_, id});
+        }
+    }
+    in_word_ = false;
+    offset_ = 0;
+}
+
+std::vector<id_match>
+id_scanner::scan(std::string_view text,
+                 std::pair<std::chrono::year_month_day, std::chrono::year_month_day> valid_date_range) {
+    std::vector<id_match> result;
+    id_scanner scanner(valid_date_range);
+    auto collect = [&](const id_match &match) { result.push_back(match); };
+    scanner.feed(text, collect);
+    scanner.finish(collect);
+    return result;
+}
+
+} // namespace idlib
@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "validator.h"
+
+namespace idlib {
+
+/**
+ * @brief A valid id found by id_scanner.
+ */
+struct id_match {
+    uint64_t offset{}; // the offset of the first character in the stream
+    decoded_id id{};
+};
+
+/**
+ * @brief Finds valid ids in free text such as logs and documents.
+ *
+ * A candidate is a word of exactly 18 characters, where a word is a maximal run of ASCII letters, digits and '_',
+ * so "ID:110101191908101015," and "身份证110101191908101015" contain an id but "a110101191908101015" does not.
+ * Candidates are validated with validator::decode(). The word boundaries come from a 64-bit mask per 64 bytes,
+ * built with SIMD compares, so text without long words is skipped a whole word at a time.
+ *
+ * Text can be fed in chunks of any size, a word that straddles chunks is carried over and its match is reported
+ * once the word ends.
+ */
+class id_scanner {
+
+    std::pair<std::chrono::year_month_day, std::chrono::year_month_day> valid_date_range_{};
+    uint64_t offset_{};     // stream offset of the next chunk
+    bool in_word_{};        // a word is open at the end of the fed text
+    uint64_t word_start_{}; // stream offset of the open word
+    char word_[18]{};       // the first characters of the open word, if it started in an earlier chunk
+
+  public:
+    using callback = std::function<void(const id_match &)>;
+
+    /**
+     * @brief Construct a new id_scanner object.
+     *
+     * @param valid_date_range The valid date range of the date of birth, bounds that are not ok() are ignored.
+     */
+    explicit id_scanner(
+        std::pair<std::chrono::year_month_day, std::chrono::year_month_day> valid_date_range = {}) noexcept;
+
+    /**
+     * @brief Scan the next chunk of the stream.
+     *
+     * @param chunk The text.
+     * @param on_match Called for every valid id that ends in this chunk, in stream order.
+     */
+    void feed(std::string_view chunk, const callback &on_match);
+
+    /**
+     * @brief End the stream, a word that reaches the end of the last chunk is reported here. The scanner can then be
+     * reused for a new stream.
+     */
+    void finish(const callback &on_match);
+
+    /**
+     * @brief Find the valid ids in a buffer.
+     */
+    static std::vector<id_match>
+    scan(std::string_view text,
+         std::pair<std::chrono::year_month_day, std::chrono::year_month_day> valid_date_range = {});
+};
+
+} // namespace idlib
@@ -0,0 +1,189 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "calendar.h"
+#include "details.h"
+#include "exhaustor.h"
+#include "mod11-2.h"
+#include "pattern.h"
+
+namespace idlib {
+
+/**
+ * @brief A string literal that can be passed as a template argument, e.g. static_exhaustor<"11010119******...">.
+ */
+template <size_t N> struct fixed_string {
+    char chars[N]{};
+
+    constexpr fixed_string(const char (&str)[N]) noexcept { std::copy_n(str, N, chars); }
+
+    [[nodiscard]] constexpr std::string_view view() const noexcept { return {chars, N - 1}; }
+};
+
+namespace detail {
+
+// Call f(std::integral_constant<unsigned, d>) for every digit d that Mask allows, in ascending order. The calls are
+// unrolled and the rejected digits never make it into the code.
+template <uint16_t Mask, typename F> constexpr void for_each_digit(F &&f) {
+    [&]<unsigned... D>(std::integer_sequence<unsigned, D...>) {
+        ([&] {
+            if constexpr ((Mask >> D) & 1) {
+                f(std::integral_constant<unsigned, D>{});
+            }
+        }(), ...);
+    }(std::make_integer_sequence<unsigned, 10>{});
+}
+
+} // namespace detail
+
+/**
+ * @brief An exhaustor for a template known at compile time.
+ *
+ * The template is compiled to a pattern at compile time, a malformed one is a compile error. The region codes that
+ * match it are looked up at compile time along with their weighted sums, the fixed digits of the date of birth add a
+ * constant to the sum, and the loops over the registry and sequence codes are unrolled over the allowed digits, so
+ * every combination of them costs one add and one table lookup for the check code. Produces the same ids in the same
+ * order as exhaustor::exhaust_all().
+ *
+ * @tparam Template The template, see pattern for the syntax.
+ */
+template <fixed_string Template> class static_exhaustor {
+
+  public:
+    static constexpr pattern kPattern{Template.view()};
+
+  private:
+    static constexpr auto kMasks = kPattern.masks();
+
+    struct region_entry {
+        std::string_view code;
+        int sum;
+    };
+
+    static constexpr size_t kRegionCount = [] {
+        size_t count = 0;
+        for (size_t i = 0; i < detail::kRegionCodeCount; i++) {
+            count += kPattern.match(kRegionCodes[i], detail::kRegionCodeStart);
+        }
+        return count;
+    }();
+
+    static constexpr auto kRegions = [] {
+        std::array<region_entry, kRegionCount> regions{};
+        size_t count = 0;
+        for (size_t i = 0; i < detail::kRegionCodeCount; i++) {
+            if (kPattern.match(kRegionCodes[i], detail::kRegionCodeStart)) {
+                regions[count++] = {kRegionCodes[i], mod11_2::weighted_sum(kRegionCodes[i])};
+            }
+        }
+        return regions;
+    }();
+
+    static constexpr bool fixed(size_t pos) { return std::has_single_bit(kMasks[pos]); }
+
+    // The weighted sum of the fixed digits of the date of birth.
+    static constexpr int kFixedDateSum = [] {
+        int sum = 0;
+        for (size_t i = detail::kDateOfBirthStart; i < detail::kDateOfBirthEnd; i++) {
+            if (fixed(i)) {
+                sum += std::countr_zero(kMasks[i]) * mod11_2::kFactors[i];
+            }
+        }
+        return sum;
+    }();
+
+    // The weighted sum of a date of birth, only the positions that are not fixed are read.
+    static int date_sum(const char *date) noexcept {
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return kFixedDateSum +
+                   (0 + ... +
+                    (fixed(detail::kDateOfBirthStart + I)
+                         ? 0
+                         : (date[I] - '0') * mod11_2::kFactors[detail::kDateOfBirthStart + I]));
+        }(std::make_index_sequence<detail::kDateOfBirthLength>{});
+    }
+
+    struct date_entry {
+        char digits[detail::kDateOfBirthLength];
+        int sum;
+    };
+
+  public:
+    /**
+     * @brief Pass every valid id matching the template to sink, in the order of exhaustor::exhaust_all().
+     *
+     * @param sink Called with a std::string_view of each id, the view is only valid during the call.
+     * @return uint64_t The number of ids.
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    template <typename Sink>
+    static uint64_t exhaust(Sink &&sink, std::chrono::year_month_day start = exhaustor::kDefaultStart,
+                            std::chrono::year_month_day end = exhaustor::today()) {
+        if (start > end) {
+            throw std::invalid_argument("The start date must be earlier than the end date.");
+        }
+        std::vector<date_entry> dates;
+        if constexpr (kRegionCount > 0) {
+            detail::date_enumerator enumerator(kPattern.date_masks(), start, end);
+            date_entry entry{};
+            while (enumerator.next(entry.digits)) {
+                entry.sum = date_sum(entry.digits);
+                dates.push_back(entry);
+            }
+        }
+
+        uint64_t count = 0;
+        char id[18];
+        for (const auto &region : kRegions) {
+            region.code.copy(id + detail::kRegionCodeStart, detail::kRegionCodeLength);
+            for (const auto &date : dates) {
+                std::copy_n(date.digits, detail::kDateOfBirthLength, id + detail::kDateOfBirthStart);
+                auto prefix_sum = region.sum + date.sum;
+                detail::for_each_digit<kMasks[detail::kRegistryCodeStart]>([&](auto first) {
+                    detail::for_each_digit<kMasks[detail::kRegistryCodeStart + 1]>([&](auto second) {
+                        detail::for_each_digit<kMasks[detail::kSequenceCodeIndex]>([&](auto sequence) {
+                            constexpr int kTailSum =
+                                decltype(first)::value * mod11_2::kFactors[detail::kRegistryCodeStart] +
+                                decltype(second)::value * mod11_2::kFactors[detail::kRegistryCodeStart + 1] +
+                                decltype(sequence)::value * mod11_2::kFactors[detail::kSequenceCodeIndex];
+                            auto cc = mod11_2::kCheckDigits[(prefix_sum + kTailSum) % 11];
+                            if (!kPattern.allows(detail::kCheckCodeIndex, cc)) {
+                                return;
+                            }
+                            id[detail::kRegistryCodeStart] = static_cast<char>('0' + decltype(first)::value);
+                            id[detail::kRegistryCodeStart + 1] = static_cast<char>('0' + decltype(second)::value);
+                            id[detail::kSequenceCodeIndex] = static_cast<char>('0' + decltype(sequence)::value);
+                            id[detail::kCheckCodeIndex] = cc;
+                            sink(std::string_view(id, sizeof(id)));
+                            ++count;
+                        });
+                    });
+                });
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Exhaust every valid id matching the template.
+     *
+     * @throw std::invalid_argument if the start date is later than the end date.
+     */
+    static std::vector<std::string> exhaust_all(std::chrono::year_month_day start = exhaustor::kDefaultStart,
+                                                std::chrono::year_month_day end = exhaustor::today()) {
+        std::vector<std::string> result;
+        exhaust([&](std::string_view id) { result.emplace_back(id); }, start, end);
+        return result;
+    }
+};
+
+} // namespace idlib
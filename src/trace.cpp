@@ -0,0 +1,153 @@
+#include "trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace idlib::trace {
+
+namespace {
+
+struct event {
+    const char *name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+// A ring of the latest events of one thread, only ever written by that thread.
+struct buffer {
+    std::vector<event> events = std::vector<event>(kEventsPerThread);
+    uint64_t count{}; // the number of events ever recorded, the next one goes to count % kEventsPerThread
+    uint32_t tid{};
+};
+
+// Buffers are owned by the registry so the events of a thread survive it. The buffer of a thread that exited is
+// handed to the next new thread, which continues its ring under the same tid, so the memory is bounded by the peak
+// number of threads that recorded at once.
+struct registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<buffer>> buffers;
+    std::vector<buffer *> free;
+};
+
+registry &global_registry() {
+    static registry instance;
+    return instance;
+}
+
+// Returns the buffer of its thread to the free list when the thread exits.
+struct buffer_lease {
+    buffer *leased;
+
+    buffer_lease() {
+        auto &r = global_registry();
+        std::lock_guard lock(r.mutex);
+        if (!r.free.empty()) {
+            leased = r.free.back();
+            r.free.pop_back();
+        } else {
+            leased = r.buffers.emplace_back(std::make_unique<buffer>()).get();
+            leased->tid = static_cast<uint32_t>(r.buffers.size());
+        }
+    }
+
+    buffer_lease(const buffer_lease &) = delete;
+    buffer_lease &operator=(const buffer_lease &) = delete;
+
+    ~buffer_lease() {
+        auto &r = global_registry();
+        std::lock_guard lock(r.mutex);
+        r.free.push_back(leased);
+    }
+};
+
+buffer &thread_buffer() {
+    thread_local buffer_lease lease;
+    return *lease.leased;
+}
+
+void write_name(std::ostream &out, const char *name) {
+    out << '"';
+    for (; *name; ++name) {
+        if (*name == '"' || *name == '\\') {
+            out << '\\';
+        }
+        out << *name;
+    }
+    out << '"';
+}
+
+// Chrome trace timestamps are in microseconds.
+void write_micros(std::ostream &out, uint64_t nanos) {
+    auto fraction = nanos % 1000;
+    out << nanos / 1000 << '.' << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10)
+        << static_cast<char>('0' + fraction % 10);
+}
+
+} // namespace
+
+void start() noexcept {
+    detail::recording.store(true, std::memory_order_relaxed);
+}
+
+void stop() noexcept {
+    detail::recording.store(false, std::memory_order_relaxed);
+}
+
+uint64_t now() noexcept {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void record(const char *name, uint64_t begin, uint64_t end) noexcept {
+    auto &b = thread_buffer();
+    b.events[b.count % kEventsPerThread] = {name, begin, end};
+    ++b.count;
+}
+
+void clear() {
+    auto &r = global_registry();
+    std::lock_guard lock(r.mutex);
+    for (auto &b : r.buffers) {
+        b->count = 0;
+    }
+}
+
+void write_chrome_json(std::ostream &out) {
+    auto &r = global_registry();
+    std::lock_guard lock(r.mutex);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (auto &b : r.buffers) {
+        auto kept = b->count < kEventsPerThread ? b->count : kEventsPerThread;
+        for (auto i = b->count - kept; i < b->count; i++) {
+            auto &e = b->events[i % kEventsPerThread];
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            write_name(out, e.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid << ",\"ts\":";
+            write_micros(out, e.begin);
+            out << ",\"dur\":";
+            write_micros(out, e.end - e.begin);
+            out << '}';
+            first = false;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void dump(const std::string &path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create " + path);
+    }
+    write_chrome_json(out);
+    if (!out.flush()) {
+        throw std::runtime_error("Failed to write the trace file.");
+    }
+}
+
+} // namespace idlib::trace
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+//
+// Opt-in tracing of the stages of validator, generator and exhaustor, written as a Chrome trace-event JSON file
+// that chrome://tracing and https://ui.perfetto.dev open.
+//
+// The stages are marked with IDLIB_TRACE_SCOPE(), which compiles to nothing unless IDLIB_TRACE is defined (the
+// xmake option "trace"). When compiled in, nothing is recorded until trace::start() is called, a stopped trace costs
+// a relaxed load per scope.
+//
+
+#if defined(IDLIB_TRACE)
+#define IDLIB_TRACE_CONCAT_IMPL(a, b) a##b
+#define IDLIB_TRACE_CONCAT(a, b) IDLIB_TRACE_CONCAT_IMPL(a, b)
+#define IDLIB_TRACE_SCOPE(name) const ::idlib::trace::scope IDLIB_TRACE_CONCAT(idlib_trace_scope_, __LINE__)(name)
+#else
+#define IDLIB_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace idlib::trace {
+
+namespace detail {
+
+inline std::atomic<bool> recording{false};
+
+} // namespace detail
+
+/**
+ * @brief The number of events kept per thread, older events are overwritten once a thread records more.
+ */
+constexpr size_t kEventsPerThread = size_t{1} << 16;
+
+/**
+ * @brief Start recording events.
+ */
+void start() noexcept;
+
+/**
+ * @brief Stop recording events, the recorded ones are kept until clear().
+ */
+void stop() noexcept;
+
+[[nodiscard]] inline bool recording() noexcept { return detail::recording.load(std::memory_order_relaxed); }
+
+/**
+ * @brief The time since an arbitrary epoch in nanoseconds, on the clock of the events.
+ */
+[[nodiscard]] uint64_t now() noexcept;
+
+/**
+ * @brief Record a complete event on the calling thread's buffer.
+ *
+ * @param name The name of the event, must outlive the trace, e.g. a string literal.
+ */
+void record(const char *name, uint64_t begin, uint64_t end) noexcept;
+
+/**
+ * @brief Drop the recorded events of every thread.
+ *
+ * Must not be called while other threads record events.
+ */
+void clear();
+
+/**
+ * @brief Write the recorded events of every thread as Chrome trace-event JSON.
+ *
+ * Must not be called while other threads record events, stop() the trace and let them finish first. The events of
+ * threads that exited are kept.
+ */
+void write_chrome_json(std::ostream &out);
+
+/**
+ * @brief Write the recorded events to a file.
+ *
+ * @throw std::runtime_error if the file cannot be written.
+ */
+void dump(const std::string &path);
+
+/**
+ * @brief Records the lifetime of the object as an event, if the trace is recording when it is constructed.
+ */
+class scope {
+
+    const char *name_;
+    uint64_t begin_;
+
+  public:
+    explicit scope(const char *name) noexcept : name_(recording() ? name : nullptr), begin_(name_ ? now() : 0) {}
+
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+    ~scope() {
+        if (name_) {
+            record(name_, begin_, now());
+        }
+    }
+};
+
+} // namespace idlib::trace
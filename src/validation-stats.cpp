@@ -0,0 +1,93 @@
+#include "validation-stats.h"
+#include "details.h"
+
+#include <stdexcept>
+
+namespace idlib {
+
+namespace {
+
+constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+size_t failure_position(std::string_view id, id_error error) noexcept {
+    switch (error) {
+    case id_error::kCharacter:
+        for (size_t i = 0; i < detail::kCheckCodeIndex; i++) {
+            if (!is_digit(id[i])) {
+                return i;
+            }
+        }
+        return detail::kCheckCodeIndex;
+    case id_error::kRegionCode:
+        return detail::kRegionCodeStart;
+    case id_error::kDateOfBirth:
+        return detail::kDateOfBirthStart;
+    default:
+        return detail::kCheckCodeIndex;
+    }
+}
+
+} // namespace
+
+validation_counts &validation_counts::operator+=(const validation_counts &other) noexcept {
+    total += other.total;
+    valid += other.valid;
+    for (size_t i = 0; i < errors.size(); i++) {
+        errors[i] += other.errors[i];
+    }
+    for (size_t i = 0; i < failures_by_position.size(); i++) {
+        failures_by_position[i] += other.failures_by_position[i];
+    }
+    for (size_t i = 0; i < kProvinces; i++) {
+        total_by_province[i] += other.total_by_province[i];
+        failures_by_province[i] += other.failures_by_province[i];
+    }
+    return *this;
+}
+
+validation_stats::validation_stats(size_t shards) : shards_(new shard[shards]{}), shard_count_(shards) {
+    if (shards == 0) {
+        throw std::invalid_argument("There must be at least one shard.");
+    }
+}
+
+void validation_stats::record(size_t shard, std::string_view id, const decoded_id &result) noexcept {
+    auto &counts = shards_[shard].counts;
+    ++counts.total;
+    bool has_province = id.size() >= 2 && is_digit(id[0]) && is_digit(id[1]);
+    auto province = has_province ? static_cast<size_t>((id[0] - '0') * 10 + (id[1] - '0')) : 0;
+    counts.total_by_province[province] += has_province;
+    if (result.ok()) {
+        ++counts.valid;
+        return;
+    }
+    ++counts.errors[static_cast<size_t>(result.error)];
+    counts.failures_by_province[province] += has_province;
+    if (result.error != id_error::kLength) {
+        ++counts.failures_by_position[failure_position(id, result.error)];
+    }
+}
+
+decoded_id validation_stats::validate(
+    size_t shard, std::string_view id,
+    const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range) noexcept {
+    auto result = validator::decode(id, valid_date_range);
+    record(shard, id, result);
+    return result;
+}
+
+validation_counts validation_stats::merge() const noexcept {
+    validation_counts result;
+    for (size_t i = 0; i < shard_count_; i++) {
+        result += shards_[i].counts;
+    }
+    return result;
+}
+
+void validation_stats::reset() noexcept {
+    for (size_t i = 0; i < shard_count_; i++) {
+        shards_[i].counts = {};
+    }
+}
+
+} // namespace idlib
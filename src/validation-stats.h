@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "validator.h"
+
+namespace idlib {
+
+/**
+ * @brief Failure counters of a validation run.
+ */
+struct validation_counts {
+    static constexpr size_t kProvinces = 100; // indexed by the first two digits of the region code
+
+    uint64_t total{};
+    uint64_t valid{};
+    std::array<uint64_t, kIdErrorCount> errors{};         // indexed by id_error, errors[kNone] is unused
+    std::array<uint64_t, 18> failures_by_position{};      // where the failure was found, see validation_stats
+    std::array<uint64_t, kProvinces> total_by_province{}; // ids that start with two digits
+    std::array<uint64_t, kProvinces> failures_by_province{};
+
+    validation_counts &operator+=(const validation_counts &other) noexcept;
+};
+
+/**
+ * @brief Collects validation_counts from many threads without locks or shared cache lines.
+ *
+ * Every thread records into its own shard, each shard is aligned to a cache line and only touched by its thread,
+ * so recording is a handful of plain increments. The shards are summed by merge() once the workers are done.
+ *
+ * The position of a failure is the first offending character for kCharacter, and the first position of the
+ * offending field for kRegionCode, kDateOfBirth and kCheckCode. Length errors have no position.
+ */
+class validation_stats {
+
+    struct alignas(64) shard {
+        validation_counts counts;
+    };
+
+    std::unique_ptr<shard[]> shards_;
+    size_t shard_count_{};
+
+  public:
+    /**
+     * @brief Construct a new validation_stats object.
+     *
+     * @param shards The number of shards, usually the number of worker threads.
+     * @throw std::invalid_argument if shards is 0.
+     */
+    explicit validation_stats(size_t shards);
+
+    [[nodiscard]] size_t shards() const noexcept { return shard_count_; }
+
+    /**
+     * @brief Count a decoded id, must only be called by the thread that owns the shard.
+     *
+     * @param shard The shard of the calling thread, in [0, shards()).
+     * @param id The id that was decoded.
+     * @param result The result of validator::decode(id).
+     */
+    void record(size_t shard, std::string_view id, const decoded_id &result) noexcept;
+
+    /**
+     * @brief Decode an id and count the result.
+     */
+    decoded_id
+    validate(size_t shard, std::string_view id,
+             const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range = {}) noexcept;
+
+    /**
+     * @brief Sum the shards, must not run concurrently with record().
+     */
+    [[nodiscard]] validation_counts merge() const noexcept;
+
+    /**
+     * @brief Zero every shard, must not run concurrently with record().
+     */
+    void reset() noexcept;
+};
+
+} // namespace idlib
@@ -1,6 +1,9 @@
 #include "validator.h"
+#include "details.h"
 #include "mod11-2.h"
 #include "region-codes.h"
+#include "trace.h"
+#include <algorithm>
 #include <stdexcept>
 
 namespace idlib {
@@ -11,16 +14,12 @@ bool validator::validate_basic(const std::string &id) {
     if (id.size() != 18) {
         return false;
     }
-    for (size_t i = 0; i < 18; i++) {
-        if (id[i] != 'X' && id[i] != 'x' && (id[i] < '0' || id[i] > '9')) {
-            return false;
-        }
-    }
-    auto cc = mod11_2::do_mod11_2(id.substr(0, 17));
-    if (cc != id[17] || (cc == 'X' && id[17] != 'x')) {
+    // -1 if the first 17 characters are not all digits, which must not compare equal to the last character.
+    auto cc = mod11_2::do_mod11_2_swar(id.data());
+    if (cc == static_cast<char>(-1)) {
         return false;
     }
-    return true;
+    return cc == id[17] || (cc == 'X' && id[17] == 'x');
 }
 
 bool validator::validate_region_code(const std::string &region_code) {
@@ -54,36 +53,107 @@ bool validator::validate_date_of_birth(
     return true;
 }
 
+decoded_id validator::decode(
+    std::string_view id,
+    const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range) noexcept {
+    using namespace std::chrono;
+    decoded_id result{};
+    if (id.size() != 18) {
+        result.error = id_error::kLength;
+        return result;
+    }
+    int sum = 0;
+    uint32_t date = 0;
+    for (size_t i = 0; i < detail::kCheckCodeIndex; i++) {
+        auto digit = static_cast<uint32_t>(id[i] - '0');
+        if (digit > 9) {
+            result.error = id_error::kCharacter;
+            return result;
+        }
+        sum += static_cast<int>(digit) * mod11_2::kFactors[i];
+        if (i >= detail::kDateOfBirthStart && i < detail::kDateOfBirthEnd) {
+            date = date * 10 + digit;
+        }
+    }
+    auto cc = id[detail::kCheckCodeIndex];
+    if (cc == 'X' || cc == 'x') {
+        result.check_code = 10;
+    } else if (cc >= '0' && cc <= '9') {
+        result.check_code = static_cast<uint8_t>(cc - '0');
+    } else {
+        result.error = id_error::kCharacter;
+        return result;
+    }
+    result.sex = static_cast<uint8_t>((id[detail::kSequenceCodeIndex] - '0') & 1);
+
+    auto region = detail::region_index(id.substr(detail::kRegionCodeStart, detail::kRegionCodeLength));
+    if (region < 0) {
+        result.error = id_error::kRegionCode;
+        return result;
+    }
+    result.region_index = static_cast<uint16_t>(region);
+
+    result.date_of_birth = date;
+    auto ymd = year(static_cast<int>(date / 10000)) / month(date / 100 % 100) / day(date % 100);
+    if (!ymd.ok() || (valid_date_range.first.ok() && ymd < valid_date_range.first) ||
+        (valid_date_range.second.ok() && ymd > valid_date_range.second)) {
+        result.error = id_error::kDateOfBirth;
+        return result;
+    }
+
+    if (mod11_2::kCheckInts[sum % 11] != result.check_code) {
+        result.error = id_error::kCheckCode;
+    }
+    return result;
+}
+
 validator::validator(std::string id,
                      std::pair<std::chrono::year_month_day, std::chrono::year_month_day> valid_date_range) noexcept
     : id_(std::move(id)), valid_date_range_(valid_date_range) {}
 
 bool validator::validate() {
-    if (id_.size() != 18) {
-        errmsg_ = "The length of the id must be 18.";
-        where_ = {0, id_.size() - 1};
-        return false;
-    }
-    for (size_t i = 0; i < 18; i++) {
-        if (id_[i] != 'X' && id_[i] != 'x' && (id_[i] < '0' || id_[i] > '9')) {
-            errmsg_ = "The id must only contain digits, 'X' and 'x'.";
-            where_ = {i, i};
+    IDLIB_TRACE_SCOPE("validator.validate");
+    {
+        IDLIB_TRACE_SCOPE("validator.characters");
+        if (id_.size() != 18) {
+            errmsg_ = "The length of the id must be 18.";
+            where_ = {0, id_.size() - 1};
+            return false;
+        }
+        // Same classification as decode(), 'X' and 'x' are only characters of the check code.
+        for (size_t i = 0; i < 17; i++) {
+            if (id_[i] < '0' || id_[i] > '9') {
+                errmsg_ = "The id must only contain digits before the check code.";
+                where_ = {i, i};
+                return false;
+            }
+        }
+        if (id_[17] != 'X' && id_[17] != 'x' && (id_[17] < '0' || id_[17] > '9')) {
+            errmsg_ = "The check code must be a digit, 'X' or 'x'.";
+            where_ = {17, 17};
             return false;
         }
     }
-    if (std::find(kRegionCodes.begin(), kRegionCodes.end(), id_.substr(0, 6)) == kRegionCodes.end()) {
-        errmsg_ = "The region code is invalid.";
-        where_ = {0, 5};
-        return false;
+    {
+        IDLIB_TRACE_SCOPE("validator.region_code");
+        if (std::find(kRegionCodes.begin(), kRegionCodes.end(), id_.substr(0, 6)) == kRegionCodes.end()) {
+            errmsg_ = "The region code is invalid.";
+            where_ = {0, 5};
+            return false;
+        }
     }
-    if (!validate_date_of_birth(id_.substr(6, 8), valid_date_range_)) {
-        errmsg_ = "The date of birth is invalid.";
-        where_ = {6, 13};
-        return false;
+    {
+        IDLIB_TRACE_SCOPE("validator.date_of_birth");
+        if (!validate_date_of_birth(id_.substr(6, 8), valid_date_range_)) {
+            errmsg_ = "The date of birth is invalid.";
+            where_ = {6, 13};
+            return false;
+        }
     }
     // Currently there is no way to validate the registry code.
     // https://www.zhihu.com/question/68016278
-    auto cc = mod11_2::do_mod11_2(id_.substr(0, 17));
+    IDLIB_TRACE_SCOPE("validator.check_code");
+    auto cc = mod11_2::do_mod11_2_swar(id_.data());
     if (cc != id_[17] && (cc != 'X' || id_[17] != 'x')) {
         errmsg_ = "The check code is invalid.";
         where_ = {17, 17};
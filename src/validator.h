@@ -1,9 +1,44 @@
 #pragma once
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace idlib {
 
+/**
+ * @brief The first problem found in an id, in the order validator::decode() and validator::validate() check them.
+ */
+enum class id_error : uint8_t {
+    kNone = 0,
+    kLength,
+    kCharacter,
+    kRegionCode,
+    kDateOfBirth,
+    kCheckCode,
+};
+
+constexpr size_t kIdErrorCount = static_cast<size_t>(id_error::kCheckCode) + 1;
+
+/**
+ * @brief The fields of an id, extracted by validator::decode().
+ *
+ * Fields are filled up to the point where decoding stopped, check `error` before using them.
+ */
+struct decoded_id {
+    uint16_t region_index{};  // index into kRegionCodes
+    uint32_t date_of_birth{}; // packed as yyyymmdd, e.g. 19190810
+    uint8_t sex{};            // 1 = male, 0 = female
+    uint8_t check_code{};     // 0-9, 10 for 'X'
+    id_error error{id_error::kNone};
+
+    [[nodiscard]] constexpr bool ok() const noexcept { return error == id_error::kNone; }
+    [[nodiscard]] constexpr bool is_male() const noexcept { return sex == 1; }
+    [[nodiscard]] constexpr int year() const noexcept { return static_cast<int>(date_of_birth / 10000); }
+    [[nodiscard]] constexpr unsigned month() const noexcept { return date_of_birth / 100 % 100; }
+    [[nodiscard]] constexpr unsigned day() const noexcept { return date_of_birth % 100; }
+};
+
 class validator {
 
     std::string id_{};
@@ -20,6 +55,17 @@ class validator {
     validate_date_of_birth(const std::string &date_of_birth,
                            const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range);
 
+    /**
+     * @brief Validate the id and extract its fields in a single pass.
+     *
+     * @param id The id to be decoded.
+     * @param valid_date_range The valid date range of the date of birth, bounds that are not ok() are ignored.
+     * @return decoded_id The decoded fields and the first error found.
+     */
+    static decoded_id
+    decode(std::string_view id,
+           const std::pair<std::chrono::year_month_day, std::chrono::year_month_day> &valid_date_range = {}) noexcept;
+
     /**
      * @brief Construct a new validator object.
      *
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "analytics.h"
+#include "calendar.h"
+#include "generator.h"
+#include "validator.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+namespace {
+
+std::vector<id_record> make_records(size_t count) {
+    std::mt19937_64 random(21);
+    generator gen(random);
+    std::vector<id_record> records(count);
+    for (auto &record : records) {
+        auto id = gen.generate_valid(year(1900) / 1 / 1, year(2024) / 12 / 31);
+        std::copy(id.begin(), id.end(), record.begin());
+    }
+    return records;
+}
+
+} // namespace
+
+TEST(analytics, extract) {
+    static_assert(detail::days_from_civil(1970, 1, 1) == 0);
+    static_assert(detail::days_from_civil(2000, 2, 29) == detail::to_day_serial(year(2000) / 2 / 29));
+    static_assert(detail::days_from_civil(1900, 3, 1) == detail::to_day_serial(year(1900) / 3 / 1));
+
+    auto records = make_records(5000);
+    std::vector<int32_t> dates(records.size());
+    std::vector<uint8_t> sexes(records.size()), provinces(records.size());
+    std::vector<int16_t> ages(records.size());
+    auto reference = year(2024) / 6 / 15;
+    extract_fields(records, dates.data(), sexes.data(), provinces.data());
+    extract_ages(records, reference, ages.data());
+    for (size_t i = 0; i < records.size(); i++) {
+        auto id = validator::decode({records[i].data(), records[i].size()});
+        ASSERT_TRUE(id.ok());
+        auto birth = year(id.year()) / month(id.month()) / day(id.day());
+        ASSERT_EQ(dates[i], detail::to_day_serial(birth));
+        ASSERT_EQ(sexes[i], id.sex);
+        ASSERT_EQ(provinces[i], (records[i][0] - '0') * 10 + (records[i][1] - '0'));
+        auto expected_age = static_cast<int>(reference.year()) - id.year() -
+                            (month_day(reference.month(), reference.day()) < month_day(birth.month(), birth.day()));
+        ASSERT_EQ(ages[i], expected_age);
+    }
+}
+
+TEST(analytics, histogram) {
+    auto records = make_records(5000);
+    auto reference = year(2000) / 1 / 1;
+    auto result = histogram(records, reference, 10, 5);
+    std::vector<int16_t> ages(records.size());
+    extract_ages(records, reference, ages.data());
+
+    std::vector<uint64_t> expected(age_histogram::kProvinces * 2 * 5);
+    uint64_t skipped = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (ages[i] < 0) {
+            ++skipped;
+            continue;
+        }
+        size_t province = (records[i][0] - '0') * 10 + (records[i][1] - '0');
+        size_t sex = (records[i][16] - '0') % 2;
+        ++expected[(province * 2 + sex) * 5 + std::min(ages[i] / 10, 4)];
+    }
+    EXPECT_EQ(result.counts, expected);
+    EXPECT_EQ(result.skipped, skipped);
+    EXPECT_GT(skipped, 0u);
+    EXPECT_THROW(histogram(records, reference, 0, 5), std::invalid_argument);
+}
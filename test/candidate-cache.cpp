@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "candidate-cache.h"
+#include "exhaustor.h"
+
+using namespace idlib;
+
+namespace {
+
+candidate_cache::key make_key(uint16_t mask) {
+    candidate_cache::key key;
+    key.kind = candidate_cache::field::kRegistryCode;
+    key.masks[0] = mask;
+    return key;
+}
+
+candidate_cache::value make_table(size_t values) {
+    auto table = std::make_shared<detail::field_table>();
+    table->values.assign(values, "00");
+    table->sums.assign(values, 0);
+    return table;
+}
+
+} // namespace
+
+TEST(candidate_cache, lru) {
+    auto bytes = make_table(100)->size_in_bytes();
+    candidate_cache cache(bytes * 3, 1);
+    int builds = 0;
+    auto get = [&](uint16_t mask) {
+        return cache.get_or_build(make_key(mask), [&] {
+            ++builds;
+            return make_table(100);
+        });
+    };
+    auto first = get(1);
+    EXPECT_EQ(get(1), first);
+    get(2);
+    get(3);
+    get(1); // 2 is now the least recently used
+    get(4);
+    EXPECT_EQ(builds, 4);
+    get(1);
+    get(3);
+    EXPECT_EQ(builds, 4);
+    get(2);
+    EXPECT_EQ(builds, 5);
+
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.hits, 4u);
+    EXPECT_EQ(stats.misses, 5u);
+    EXPECT_EQ(stats.evictions, 2u);
+    EXPECT_EQ(stats.entries, 3u);
+    EXPECT_EQ(stats.bytes, bytes * 3);
+
+    cache.set_capacity(bytes);
+    EXPECT_EQ(cache.statistics().entries, 1u);
+    cache.set_capacity(0);
+    EXPECT_EQ(cache.statistics().entries, 0u);
+    get(1);
+    EXPECT_EQ(cache.statistics().entries, 0u);
+}
+
+TEST(candidate_cache, exhaustor) {
+    auto start = std::chrono::year(1990) / 1 / 1;
+    auto end = std::chrono::year(1990) / 12 / 31;
+    auto &cache = candidate_cache::global();
+    cache.clear();
+    auto expected = exhaustor("11010*199*0[1-2]***[0-3]f*").exhaust_all(start, end);
+    auto before = cache.statistics();
+
+    std::vector<std::jthread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10; i++) {
+                exhaustor ex("11010*199*0[1-2]***[0-3]f*");
+                EXPECT_EQ(ex.range(0, ex.size(start, end), start, end), expected);
+            }
+        });
+    }
+    threads.clear();
+    auto after = cache.statistics();
+    EXPECT_EQ(after.misses, before.misses);
+    EXPECT_EQ(after.hits - before.hits, 4u * 10u * 3u);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "column-store.h"
+#include "generator.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+namespace {
+
+std::string temp_path(const char *name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+std::string to_string(const id_record &id) { return {id.data(), id.size()}; }
+
+// Copy the file to path with value written over the bytes at offset, a negative offset counts from the end.
+template <typename T> void corrupt_copy(const std::string &from, const std::string &path, int64_t offset, T value) {
+    std::ifstream in(from, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    auto at = offset < 0 ? static_cast<int64_t>(bytes.size()) + offset : offset;
+    std::memcpy(bytes.data() + at, &value, sizeof(T));
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+}
+
+} // namespace
+
+TEST(column_store, round_trip) {
+    std::mt19937 random(42);
+    generator gen(random);
+    std::vector<std::string> ids;
+    for (int i = 0; i < 10000; i++) {
+        ids.push_back(gen.generate_valid(year(1920) / 1 / 1, year(2020) / 12 / 31));
+    }
+    ids.emplace_back("32128319301023294X");
+    ids.emplace_back("110101191908101016"); // wrong check code is kept as is
+
+    auto path = temp_path("idlib_column_store_round_trip.idc");
+    {
+        column_writer writer(path, 1000);
+        for (auto &id : ids) {
+            writer.write(id);
+        }
+        EXPECT_THROW(writer.write("000000191908101015"), std::invalid_argument);
+        EXPECT_THROW(writer.write("110101190002291014"), std::invalid_argument);
+        EXPECT_THROW(writer.write("11010119190810101"), std::invalid_argument);
+        writer.finish();
+    }
+
+    column_reader reader(path);
+    EXPECT_EQ(reader.size(), ids.size());
+    EXPECT_EQ(reader.blocks().size(), 11u);
+    std::vector<std::string> read;
+    EXPECT_EQ(reader.scan({}, [&](const id_record &id) { read.push_back(to_string(id)); }), ids.size());
+    EXPECT_EQ(read, ids);
+
+    std::vector<id_record> block;
+    reader.read_block(10, block);
+    ASSERT_EQ(block.size(), 2u);
+    EXPECT_EQ(to_string(block[0]), "32128319301023294X");
+
+    auto filter = column_filter{}.region_prefix("11").date_range(year(1950) / 1 / 1, year(1959) / 12 / 31);
+    std::vector<std::string> expected;
+    for (auto &id : ids) {
+        if (id.starts_with("11") && id.substr(6, 8) >= "19500101" && id.substr(6, 8) <= "19591231") {
+            expected.push_back(id);
+        }
+    }
+    read.clear();
+    reader.scan(filter, [&](const id_record &id) { read.push_back(to_string(id)); });
+    EXPECT_EQ(read, expected);
+    std::filesystem::remove(path);
+}
+
+TEST(column_store, block_skipping) {
+    auto path = temp_path("idlib_column_store_block_skipping.idc");
+    {
+        column_writer writer(path, 2);
+        writer.write("110101191908101015");
+        writer.write("110101191908101023");
+        writer.write("450102198001010015");
+    }
+    column_reader reader(path);
+    ASSERT_EQ(reader.blocks().size(), 2u);
+    EXPECT_EQ(reader.blocks()[0].region_first, reader.blocks()[0].region_last);
+    EXPECT_EQ(reader.blocks()[0].date_first, reader.blocks()[0].date_last);
+    std::vector<std::string> read;
+    reader.scan(column_filter{}.region_prefix("45"), [&](const id_record &id) { read.push_back(to_string(id)); });
+    EXPECT_EQ(read, std::vector<std::string>{"450102198001010015"});
+    EXPECT_THROW(column_filter{}.region_prefix("99"), std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+TEST(column_store, corrupted) {
+    auto path = temp_path("idlib_column_store_corrupted.idc");
+    auto copy = temp_path("idlib_column_store_corrupted_copy.idc");
+    {
+        column_writer writer(path, 2);
+        writer.write("110101191908101015");
+        writer.write("450102198001010015");
+    }
+    int64_t block = static_cast<int64_t>(column_reader(path).blocks()[0].offset);
+    auto scan = [&] { column_reader(copy).scan({}, [](const id_record &) {}); };
+
+    // Rows that run past the end of the file.
+    corrupt_copy(path, copy, block, uint32_t{0xffffffff});
+    EXPECT_THROW(scan(), std::runtime_error);
+    // A region column wider than 32 bits.
+    corrupt_copy(path, copy, block + 12, uint8_t{200});
+    EXPECT_THROW(scan(), std::runtime_error);
+    // An index offset that would wrap around when added to the index size.
+    corrupt_copy(path, copy, -16, ~uint64_t{0} - 8);
+    EXPECT_THROW(column_reader{copy}, std::runtime_error);
+
+    std::filesystem::copy_file(path, copy, std::filesystem::copy_options::overwrite_existing);
+    EXPECT_NO_THROW(scan());
+    std::filesystem::remove(path);
+    std::filesystem::remove(copy);
+}
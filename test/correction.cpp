@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include "correction.h"
+#include "generator.h"
+#include "validator.h"
+
+using namespace idlib;
+
+namespace {
+
+// Every valid id one substitution or adjacent transposition away, tried one by one.
+std::set<std::string> brute_force(const std::string &id) {
+    std::set<std::string> result;
+    for (size_t i = 0; i < 18; i++) {
+        for (char c : std::string_view(i == 17 ? "0123456789X" : "0123456789")) {
+            auto candidate = id;
+            candidate[i] = c;
+            if (candidate != id && validator::decode(candidate).ok()) {
+                result.insert(candidate);
+            }
+        }
+        if (i + 1 < 18 && id[i] != id[i + 1]) {
+            auto candidate = id;
+            std::swap(candidate[i], candidate[i + 1]);
+            if (validator::decode(candidate).ok()) {
+                result.insert(candidate);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(correction, suggest) {
+    auto suggestions = suggest_corrections("110101191908011015");
+    ASSERT_FALSE(suggestions.empty());
+    EXPECT_EQ(suggestions.front().id, "110101191908101015");
+    EXPECT_EQ(suggestions.front().kind, correction_kind::kTransposition);
+    EXPECT_EQ(suggestions.front().position, 12);
+    EXPECT_EQ(suggestions.back().kind, correction_kind::kCheckCode);
+
+    EXPECT_TRUE(suggest_corrections("110101191908101015").empty());
+    EXPECT_TRUE(suggest_corrections("11010119190810101").empty());
+    EXPECT_TRUE(suggest_corrections("1101011919081010a5").empty());
+}
+
+TEST(correction, brute_force) {
+    std::mt19937_64 random(5);
+    generator gen(random);
+    for (int round = 0; round < 2000; round++) {
+        auto id = gen.generate_valid(std::chrono::year(1950) / 1 / 1, std::chrono::year(2020) / 12 / 31);
+        auto typo = id;
+        auto pos = random() % 17;
+        if (random() % 2) {
+            std::swap(typo[pos], typo[pos + 1]);
+        } else {
+            typo[pos] = static_cast<char>('0' + random() % 10);
+        }
+        if (validator::decode(typo).ok()) {
+            continue;
+        }
+        std::set<std::string> suggested;
+        for (auto &c : suggest_corrections(typo)) {
+            suggested.insert(c.id);
+        }
+        ASSERT_EQ(suggested, brute_force(typo)) << typo;
+        ASSERT_TRUE(suggested.contains(id)) << typo;
+    }
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include "details.h"
+#include "exhaustor.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+namespace {
+
+bool match(std::string_view str, std::string_view tmpl) {
+    for (size_t i = 0; i < str.size(); i++) {
+        if (tmpl[i] != '*' && tmpl[i] != str[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> brute_force_dates(std::string_view tmpl, year_month_day start, year_month_day end) {
+    std::vector<std::string> result;
+    for (auto d = sys_days(start); d <= sys_days(end); d += days{1}) {
+        auto str = detail::ymd2str(year_month_day{d});
+        if (match(str, tmpl)) {
+            result.push_back(str);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(exhaustor, pattern) {
+    pattern p("11****19[0-3]*08[13579]*[0-25]*mX");
+    EXPECT_EQ(p.mask(0), 1 << 1);
+    EXPECT_EQ(p.mask(2), pattern::kDigits);
+    EXPECT_EQ(p.mask(8), 0xf);
+    EXPECT_EQ(p.mask(12), pattern::kOddDigits);
+    EXPECT_EQ(p.mask(14), 0x27);
+    EXPECT_EQ(p.mask(16), pattern::kOddDigits);
+    EXPECT_EQ(p.mask(17), pattern::kX);
+    EXPECT_EQ(pattern("******************").mask(17), pattern::kDigits | pattern::kX);
+    EXPECT_EQ(pattern("*****************[0-2x]").mask(17), 0x7 | pattern::kX);
+    EXPECT_TRUE(p.match("110101193908"));
+    EXPECT_FALSE(p.match("110101194908"));
+    EXPECT_TRUE(p.allows(17, 'x'));
+
+    EXPECT_THROW(pattern("11****19190810***"), std::invalid_argument);
+    EXPECT_THROW(pattern("11****19190810****0"), std::invalid_argument);
+    EXPECT_THROW(pattern("11****19190810**m[0"), std::invalid_argument);
+    EXPECT_THROW(pattern("11****19190810**m[]"), std::invalid_argument);
+    EXPECT_THROW(pattern("11****19190810**m[3-1]"), std::invalid_argument);
+    EXPECT_THROW(pattern("11****1919081m***0"), std::invalid_argument);
+    EXPECT_THROW(pattern("11****19190810*X*0"), std::invalid_argument);
+}
+
+TEST(exhaustor, exhaust_date_of_birth) {
+    auto start = year(1920) / 1 / 1;
+    auto end = year(2023) / 12 / 31;
+    for (auto tmpl : {"********", "1919****", "****0810", "19**01**", "****12*1", "2000022*", "*9*9*2*9", "19190230"}) {
+        std::string id = "110101" + std::string(tmpl) + "****";
+        EXPECT_EQ(exhaustor(id).exhaust_date_of_birth(start, end), brute_force_dates(tmpl, start, end)) << tmpl;
+    }
+    auto narrow_start = year(1990) / 2 / 15;
+    auto narrow_end = year(1990) / 3 / 3;
+    EXPECT_EQ(exhaustor("110101********1234").exhaust_date_of_birth(narrow_start, narrow_end),
+              brute_force_dates("********", narrow_start, narrow_end));
+}
+
+TEST(exhaustor, exhaust_all) {
+    auto start = year(1900) / 1 / 1;
+    auto end = year(2000) / 1 / 1;
+    auto result = exhaustor("11010119190810101*").exhaust_all(start, end);
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0], "110101191908101015");
+
+    result = exhaustor("1101011919081010m5").exhaust_all(start, end);
+    EXPECT_EQ(result, std::vector<std::string>{"110101191908101015"});
+
+    result = exhaustor("1101011919081010fX").exhaust_all(start, end);
+    EXPECT_EQ(result, std::vector<std::string>{"11010119190810104X"});
+
+    result = exhaustor("11010[1-5]19190810[0-2]1[0-2]*").exhaust_all(start, end);
+    EXPECT_EQ(result.size(), 3u * 3u * 3u);
+    for (auto &id : result) {
+        EXPECT_TRUE(match(id, "11010*19190810*1**"));
+    }
+
+    result = exhaustor("11010*1919081010**").exhaust_all(start, end);
+    EXPECT_EQ(result.size(), 7u * 10u);
+    for (auto &id : result) {
+        EXPECT_TRUE(match(id, "11010*1919081010**"));
+    }
+}
+
+TEST(exhaustor, range) {
+    auto start = year(1990) / 1 / 1;
+    auto end = year(1990) / 12 / 31;
+    exhaustor ex("11010*199*0[1-2]***[0-3]f*");
+    auto all = ex.exhaust_all(start, end);
+    auto size = ex.size(start, end);
+    EXPECT_EQ(size, 7u * (31u + 28u) * 10u * 4u * 5u);
+
+    std::vector<std::string> sliced;
+    for (uint64_t begin = 0; begin < size; begin += 997) {
+        auto part = ex.range(begin, std::min(size, begin + 997), start, end);
+        sliced.insert(sliced.end(), part.begin(), part.end());
+    }
+    EXPECT_EQ(sliced, all);
+
+    std::vector<std::string> unranked;
+    for (uint64_t i = 0; i < size; i++) {
+        if (auto id = ex.nth(i, start, end)) {
+            unranked.push_back(*id);
+        }
+    }
+    EXPECT_EQ(unranked, all);
+
+    EXPECT_TRUE(ex.range(size, size, start, end).empty());
+    EXPECT_THROW(ex.range(0, size + 1, start, end), std::out_of_range);
+    EXPECT_THROW(ex.nth(size, start, end), std::out_of_range);
+}
+
+TEST(exhaustor, cursor) {
+    auto start = year(1990) / 1 / 1;
+    auto end = year(1990) / 12 / 31;
+    auto all = exhaustor("11010*199*0[1-2]***[0-3]f*").exhaust_all(start, end);
+
+    std::vector<std::string> resumed;
+    exhaust_cursor cursor;
+    while (true) {
+        // Every batch runs on a fresh exhaustor from a serialized checkpoint, like a restarted job.
+        auto checkpoint = cursor.serialize();
+        exhaustor ex("11010*199*0[1-2]***[0-3]f*");
+        cursor = exhaust_cursor::deserialize(checkpoint);
+        auto batch = ex.exhaust(cursor, 1000, start, end);
+        if (batch.empty()) {
+            break;
+        }
+        EXPECT_LE(batch.size(), 1000u);
+        resumed.insert(resumed.end(), batch.begin(), batch.end());
+    }
+    EXPECT_EQ(resumed, all);
+
+    exhaustor other("11010*199*0[1-2]***[0-3]m*");
+    EXPECT_THROW(other.exhaust(cursor, 1000, start, end), std::invalid_argument);
+    EXPECT_THROW(exhaustor("11010*199*0[1-2]***[0-3]f*").exhaust(cursor, 1000, start, year(1991) / 1 / 1),
+                 std::invalid_argument);
+    auto data = cursor.serialize();
+    data[0] = 0;
+    EXPECT_THROW(exhaust_cursor::deserialize(data), std::invalid_argument);
+}
+
+TEST(exhaustor, exhaust_batch) {
+    auto start = year(1990) / 1 / 1;
+    auto end = year(1990) / 12 / 31;
+    std::vector<pattern> templates;
+    for (auto tmpl : {"11010*199*0[1-2]***[0-3]f*", "11010*199*0[1-2]**1[0-3]m*", "3212**199*0[1-2]***[0-3]f*",
+                      "11010*199*1***0[0-3]**", "11010*199*0[1-2]***[0-3]f*"}) {
+        templates.emplace_back(tmpl);
+    }
+    std::vector<std::vector<std::string>> streamed(templates.size());
+    size_t last = 0;
+    exhaustor::exhaust_batch(
+        templates,
+        [&](size_t index, std::string_view id) {
+            EXPECT_GE(index, last);
+            last = index;
+            streamed[index].emplace_back(id);
+        },
+        start, end);
+    for (size_t i = 0; i < templates.size(); i++) {
+        EXPECT_EQ(streamed[i], exhaustor(templates[i]).exhaust_all(start, end)) << i;
+    }
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "generator.h"
+#include "validator.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+TEST(generator, alias_table) {
+    std::vector<double> weights{1, 0, 3, 6};
+    alias_table table(weights);
+    std::mt19937_64 random(1);
+    std::vector<int> counts(weights.size());
+    constexpr int kDraws = 1000000;
+    for (int i = 0; i < kDraws; i++) {
+        counts[table(random)]++;
+    }
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_NEAR(counts[0], kDraws * 0.1, kDraws * 0.005);
+    EXPECT_NEAR(counts[2], kDraws * 0.3, kDraws * 0.005);
+    EXPECT_NEAR(counts[3], kDraws * 0.6, kDraws * 0.005);
+
+    EXPECT_THROW(alias_table(std::vector<double>{}), std::invalid_argument);
+    EXPECT_THROW(alias_table(std::vector<double>{0, 0}), std::invalid_argument);
+    EXPECT_THROW(alias_table(std::vector<double>{1, -1}), std::invalid_argument);
+}
+
+TEST(generator, parts) {
+    static_assert(generator<std::mt19937_64>::kAll ==
+                  (generator<std::mt19937_64>::kRegionCode | generator<std::mt19937_64>::kDateOfBirth |
+                   generator<std::mt19937_64>::kCheckCode));
+    std::mt19937_64 random(11);
+    generator gen(random);
+    std::pair<year_month_day, year_month_day> range{year(1950) / 1 / 1, year(2000) / 12 / 31};
+    for (uint64_t parts = 0; parts <= gen.kAll; parts++) {
+        for (int i = 0; i < 200; i++) {
+            auto id = gen.generate(parts, range.first, range.second);
+            ASSERT_EQ(id.size(), 18u) << id;
+            // Each part is valid exactly when its flag is set.
+            EXPECT_EQ(validator::validate_region_code(id.substr(0, 6)), (parts & gen.kRegionCode) != 0) << id;
+            EXPECT_EQ(validator::validate_date_of_birth(id.substr(6, 8), range), (parts & gen.kDateOfBirth) != 0)
+                << id;
+            EXPECT_EQ(mod11_2::do_mod11_2(id.substr(0, 17)) == id[17], (parts & gen.kCheckCode) != 0) << id;
+        }
+    }
+}
+
+TEST(generator, weighted) {
+    generator_weights weights;
+    weights.regions = {{"11", 3}, {"110101", 1}};
+    weights.birth_years = {{1990, 1}, {2000, 3}};
+    weights.male_ratio = 0.8;
+    std::mt19937_64 random(7);
+    generator gen(random, weights);
+
+    constexpr int kDraws = 20000;
+    int dongcheng = 0, year_2000 = 0, male = 0;
+    for (int i = 0; i < kDraws; i++) {
+        auto id = gen.generate_valid(year(1980) / 1 / 1, year(2010) / 12 / 31);
+        auto decoded = validator::decode(id);
+        ASSERT_TRUE(decoded.ok()) << id;
+        ASSERT_TRUE(id.starts_with("11")) << id;
+        ASSERT_TRUE(decoded.year() == 1990 || decoded.year() == 2000) << id;
+        dongcheng += id.starts_with("110101");
+        year_2000 += decoded.year() == 2000;
+        male += decoded.is_male();
+    }
+    EXPECT_NEAR(year_2000, kDraws * 0.75, kDraws * 0.02);
+    EXPECT_NEAR(male, kDraws * 0.8, kDraws * 0.02);
+    // 110101 gets its own weight plus its share of the province.
+    EXPECT_GT(dongcheng, kDraws / 4);
+
+    // Years outside of the range are dropped and the rest renormalized.
+    weights.birth_years = {{1970, 5}, {1990, 1}, {2000, 3}, {2030, 5}};
+    generator clipped(random, weights);
+    year_2000 = 0;
+    for (int i = 0; i < kDraws; i++) {
+        auto decoded = validator::decode(clipped.generate_valid(year(1990) / 6 / 1, year(2010) / 12 / 31));
+        ASSERT_TRUE(decoded.year() == 1990 || decoded.year() == 2000);
+        ASSERT_GE(decoded.date_of_birth, 19900601u);
+        year_2000 += decoded.year() == 2000;
+    }
+    EXPECT_NEAR(year_2000, kDraws * 0.75, kDraws * 0.02);
+    EXPECT_THROW(clipped.generate_valid(year(2010) / 1 / 1, year(2020) / 12 / 31), std::invalid_argument);
+    weights.birth_years = {{1990, 0}, {2000, 1}};
+    generator zero_weight(random, weights);
+    EXPECT_THROW(zero_weight.generate_valid(year(1990) / 1 / 1, year(1999) / 12 / 31), std::invalid_argument);
+    EXPECT_EQ(validator::decode(zero_weight.generate_valid(year(1990) / 1 / 1, year(2000) / 1 / 1)).date_of_birth,
+              20000101u);
+
+    weights.birth_years = {{1990, 0}, {2000, -1}};
+    EXPECT_THROW(generator(random, weights), std::invalid_argument);
+    weights.birth_years = {{1990, 0}, {2000, 0}};
+    EXPECT_THROW(generator(random, weights), std::invalid_argument);
+    weights.birth_years = {{1990, std::numeric_limits<double>::infinity()}};
+    EXPECT_THROW(generator(random, weights), std::invalid_argument);
+    weights.birth_years = {};
+    weights.regions = {{"99", 1}};
+    EXPECT_THROW(generator(random, weights), std::invalid_argument);
+    weights.regions = {};
+    weights.male_ratio = 1.5;
+    EXPECT_THROW(generator(random, weights), std::invalid_argument);
+}
+
+TEST(generator, feistel_permutation) {
+    for (uint64_t domain : {1ULL, 2ULL, 5ULL, 7ULL, 1000ULL, 4097ULL, 65537ULL}) {
+        detail::feistel_permutation permutation(domain, 42);
+        std::vector<bool> seen(domain);
+        for (uint64_t i = 0; i < domain; i++) {
+            auto image = permutation(i);
+            ASSERT_LT(image, domain);
+            ASSERT_FALSE(seen[image]);
+            seen[image] = true;
+            ASSERT_EQ(permutation.inverse(image), i);
+        }
+    }
+    EXPECT_THROW(detail::feistel_permutation(0, 1), std::invalid_argument);
+}
+
+TEST(generator, unique) {
+    unique_generator gen(1234, year(2000) / 2 / 29, year(2000) / 2 / 29);
+    std::vector<uint64_t> packed(gen.size());
+    char id[18];
+    for (uint64_t i = 0; i < gen.size(); i++) {
+        gen.generate(i, id);
+        auto decoded = validator::decode({id, 18});
+        ASSERT_TRUE(decoded.ok()) << std::string_view(id, 18);
+        ASSERT_EQ(decoded.date_of_birth, 20000229u);
+        packed[i] = pack_id({id, 18});
+    }
+    std::sort(packed.begin(), packed.end());
+    EXPECT_EQ(std::adjacent_find(packed.begin(), packed.end()), packed.end());
+
+    EXPECT_EQ(unique_generator(1234, year(2000) / 2 / 29, year(2000) / 2 / 29).generate(5), gen.generate(5));
+    EXPECT_NE(unique_generator(4321, year(2000) / 2 / 29, year(2000) / 2 / 29).generate(5), gen.generate(5));
+    EXPECT_THROW((void)gen.generate(gen.size()), std::out_of_range);
+    EXPECT_THROW(unique_generator(1, year(2000) / 3 / 1, year(2000) / 2 / 28), std::invalid_argument);
+}
+
+TEST(generator, matching) {
+    auto start = year(1990) / 1 / 1;
+    auto end = year(1990) / 12 / 31;
+    std::mt19937_64 random(17);
+    generator gen(random);
+
+    for (auto tmpl : {"11010*199*0[1-2]***[0-3]f*", "1101011990****123X", "11010*1990010[1-3]**[13]5"}) {
+        exhaustor ex(tmpl);
+        auto all = ex.exhaust_all(start, end);
+        ASSERT_FALSE(all.empty()) << tmpl;
+        std::map<std::string, int> counts;
+        auto draws = static_cast<int>(all.size()) * 50;
+        for (int i = 0; i < draws; i++) {
+            counts[gen.generate_matching(ex, start, end)]++;
+        }
+        // Every matching id is drawn and nothing else, about 50 times each.
+        ASSERT_EQ(counts.size(), all.size()) << tmpl;
+        for (auto &id : all) {
+            ASSERT_TRUE(counts.contains(id));
+            EXPECT_NEAR(counts[id], 50, 35) << tmpl;
+        }
+    }
+    EXPECT_EQ(gen.generate_matching("110101191908101015", year(1900) / 1 / 1, end), "110101191908101015");
+    EXPECT_THROW(gen.generate_matching("110101191908101016", year(1900) / 1 / 1, end), std::invalid_argument);
+}
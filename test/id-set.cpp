@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <unordered_set>
+
+#include "id-set.h"
+
+using namespace idlib;
+
+TEST(id_set, pack_id) {
+    EXPECT_EQ(unpack_id(pack_id("110101191908101015")), "110101191908101015");
+    EXPECT_EQ(unpack_id(pack_id("32128319301023294X")), "32128319301023294X");
+    EXPECT_EQ(pack_id("32128319301023294x"), pack_id("32128319301023294X"));
+    EXPECT_EQ(unpack_id(pack_id("000000000000000000")), "000000000000000000");
+    EXPECT_LT(pack_id("110101191908101019"), pack_id("11010119190810101X"));
+    EXPECT_EQ(pack_id("11010119190810101"), kInvalidPackedId);
+    EXPECT_EQ(pack_id("1101011919081010X5"), kInvalidPackedId);
+    EXPECT_EQ(pack_id("11010119190810101Y"), kInvalidPackedId);
+}
+
+TEST(id_set, insert_contains) {
+    std::mt19937_64 random(42);
+    std::vector<uint64_t> keys(100000);
+    for (auto &key : keys) {
+        key = (random() % 100000000000000000ULL) << 4 | random() % 11;
+    }
+    keys[10] = keys[20];
+    std::unordered_set<uint64_t> expected(keys.begin(), keys.end());
+
+    id_set set;
+    auto inserted = std::make_unique<bool[]>(keys.size());
+    EXPECT_EQ(set.insert(keys, inserted.get()), expected.size());
+    EXPECT_FALSE(inserted[20]);
+    EXPECT_EQ(set.size(), expected.size());
+    EXPECT_LE(set.size(), set.capacity());
+    for (auto key : keys) {
+        EXPECT_TRUE(set.contains(key));
+        EXPECT_FALSE(set.insert(key));
+    }
+    EXPECT_FALSE(set.contains(pack_id("110101191908101015")));
+    EXPECT_TRUE(set.insert("110101191908101015"));
+    EXPECT_FALSE(set.insert("110101191908101015"));
+    EXPECT_FALSE(set.insert("11010119190810101"));
+    EXPECT_TRUE(set.contains("110101191908101015"));
+
+    std::vector<uint64_t> probes = {keys[0], keys[1], 12345, pack_id("110101191908101015")};
+    auto found = std::make_unique<bool[]>(probes.size());
+    EXPECT_EQ(set.contains(probes, found.get()), 3u);
+    EXPECT_FALSE(found[2]);
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(keys[0]));
+}
+
+TEST(id_set, bloom_filter) {
+    std::mt19937_64 random(42);
+    std::vector<uint64_t> keys(100000);
+    for (auto &key : keys) {
+        key = random() >> 4;
+    }
+    id_bloom_filter filter(keys.size());
+    filter.insert(keys);
+    for (auto key : keys) {
+        EXPECT_TRUE(filter.maybe_contains(key));
+    }
+    size_t false_positives = 0;
+    for (size_t i = 0; i < 100000; i++) {
+        false_positives += filter.maybe_contains(random() >> 4);
+    }
+    EXPECT_LT(false_positives, 3000u);
+}
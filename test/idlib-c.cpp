@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "idlib-c.h"
+#include "validator.h"
+
+using namespace idlib;
+
+namespace {
+
+const std::vector<std::string> kIds = {
+    "110101191908101015", // valid
+    "32128319301023294X", // valid
+    "110101191908101016", // check code
+    "990101191908101019", // region code
+    "110101191902301016", // date of birth
+    "11010119190810101a", // character
+};
+
+const std::vector<uint8_t> kErrors = {IDLIB_OK, IDLIB_OK, IDLIB_ERROR_CHECK_CODE, IDLIB_ERROR_REGION_CODE,
+                                      IDLIB_ERROR_DATE_OF_BIRTH, IDLIB_ERROR_CHARACTER};
+
+// The ids laid out with a stride, the bytes between records are filled with garbage.
+std::vector<char> records(size_t stride, size_t length = IDLIB_ID_LENGTH) {
+    std::vector<char> result(kIds.size() * stride, '#');
+    for (size_t i = 0; i < kIds.size(); i++) {
+        std::memcpy(result.data() + i * stride, kIds[i].data(), length);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(idlib_c, error_codes) {
+    static_assert(IDLIB_OK == static_cast<int>(id_error::kNone));
+    static_assert(IDLIB_ERROR_LENGTH == static_cast<int>(id_error::kLength));
+    static_assert(IDLIB_ERROR_CHARACTER == static_cast<int>(id_error::kCharacter));
+    static_assert(IDLIB_ERROR_REGION_CODE == static_cast<int>(id_error::kRegionCode));
+    static_assert(IDLIB_ERROR_DATE_OF_BIRTH == static_cast<int>(id_error::kDateOfBirth));
+    static_assert(IDLIB_ERROR_CHECK_CODE == static_cast<int>(id_error::kCheckCode));
+    static_assert(IDLIB_ERROR_CHECK_CODE + 1 == kIdErrorCount);
+
+    EXPECT_EQ(idlib_abi_version(), static_cast<uint32_t>(IDLIB_ABI_VERSION));
+    std::set<std::string> messages;
+    for (int error = 0; error < static_cast<int>(kIdErrorCount); error++) {
+        messages.insert(idlib_error_message(error));
+    }
+    EXPECT_EQ(messages.size(), kIdErrorCount);
+    EXPECT_STREQ(idlib_error_message(IDLIB_ERROR_CHECK_CODE), "The check code is invalid.");
+    EXPECT_STREQ(idlib_error_message(-1), "Unknown error.");
+    EXPECT_STREQ(idlib_error_message(static_cast<int>(kIdErrorCount)), "Unknown error.");
+}
+
+TEST(idlib_c, validate_and_decode) {
+    for (size_t stride : {size_t{18}, size_t{19}}) {
+        auto data = records(stride);
+        std::vector<uint8_t> errors(kIds.size(), 0xff);
+        EXPECT_EQ(idlib_validate(data.data(), kIds.size(), stride, 0, 0, errors.data()), 2u) << stride;
+        EXPECT_EQ(errors, kErrors) << stride;
+        EXPECT_EQ(idlib_validate(data.data(), kIds.size(), stride, 0, 0, nullptr), 2u) << stride;
+        // 1919-08-10 is before the lower bound.
+        EXPECT_EQ(idlib_validate(data.data(), kIds.size(), stride, 19200101, 0, nullptr), 1u) << stride;
+
+        std::vector<idlib_decoded> decoded(kIds.size());
+        EXPECT_EQ(idlib_decode(data.data(), kIds.size(), stride, 0, 0, decoded.data()), 2u) << stride;
+        for (size_t i = 0; i < kIds.size(); i++) {
+            auto expected = validator::decode(kIds[i]);
+            EXPECT_EQ(decoded[i].error, kErrors[i]);
+            if (expected.ok()) {
+                EXPECT_EQ(decoded[i].date_of_birth, expected.date_of_birth);
+                EXPECT_EQ(decoded[i].region_index, expected.region_index);
+                EXPECT_EQ(decoded[i].sex, expected.sex);
+                EXPECT_EQ(decoded[i].check_code, expected.check_code);
+            }
+        }
+        EXPECT_EQ(decoded[1].check_code, 10);
+    }
+    auto data = records(18);
+    // Malformed or reversed bounds are rejected instead of being ignored.
+    for (auto [date_min, date_max] : {std::pair<uint32_t, uint32_t>{20231332, 0}, {0, 19900230}, {19191301, 20001231},
+                                      {20001231, 19900101}, {1, 0}}) {
+        std::vector<uint8_t> errors(kIds.size(), 0xff);
+        EXPECT_EQ(idlib_validate(data.data(), kIds.size(), 18, date_min, date_max, errors.data()), 0u) << date_min;
+        EXPECT_EQ(errors, std::vector<uint8_t>(kIds.size(), 0xff)) << date_min;
+        std::vector<idlib_decoded> decoded(kIds.size());
+        EXPECT_EQ(idlib_decode(data.data(), kIds.size(), 18, date_min, date_max, decoded.data()), 0u) << date_min;
+    }
+    EXPECT_EQ(idlib_validate(data.data(), kIds.size(), 18, 19190810, 19190810, nullptr), 1u);
+    EXPECT_EQ(idlib_validate(data.data(), kIds.size(), 17, 0, 0, nullptr), 0u);
+    EXPECT_EQ(idlib_validate(nullptr, kIds.size(), 18, 0, 0, nullptr), 0u);
+    EXPECT_EQ(idlib_decode(data.data(), kIds.size(), 18, 0, 0, nullptr), 0u);
+}
+
+TEST(idlib_c, check_codes) {
+    auto data = records(17, 17);
+    std::vector<char> out(kIds.size(), '?');
+    EXPECT_EQ(idlib_check_codes(data.data(), kIds.size(), 17, out.data()), kIds.size());
+    EXPECT_EQ(std::string(out.begin(), out.end()), "5X5965");
+
+    data[3 * 17 + 4] = 'a';
+    EXPECT_EQ(idlib_check_codes(data.data(), kIds.size(), 17, out.data()), kIds.size() - 1);
+    EXPECT_EQ(out[3], 0);
+    EXPECT_EQ(idlib_check_codes(data.data(), kIds.size(), 16, out.data()), 0u);
+}
+
+TEST(idlib_c, generate) {
+    constexpr size_t kCount = 100;
+    constexpr size_t kStride = 20;
+    std::vector<char> first(kCount * kStride, '#');
+    std::vector<char> second(kCount * kStride, '#');
+    EXPECT_EQ(idlib_generate(first.data(), kCount, kStride, 42, 19900101, 20001231), kCount);
+    EXPECT_EQ(idlib_generate(second.data(), kCount, kStride, 42, 19900101, 20001231), kCount);
+    EXPECT_EQ(first, second);
+    std::vector<uint8_t> errors(kCount);
+    EXPECT_EQ(idlib_validate(first.data(), kCount, kStride, 19900101, 20001231, errors.data()), kCount);
+    EXPECT_EQ(first[18], '#'); // the bytes between records are left alone
+
+    EXPECT_EQ(idlib_generate(second.data(), kCount, kStride, 43, 19900101, 20001231), kCount);
+    EXPECT_NE(first, second);
+
+    EXPECT_EQ(idlib_generate(nullptr, kCount, kStride, 42, 19900101, 20001231), 0u);
+    EXPECT_EQ(idlib_generate(first.data(), kCount, 17, 42, 19900101, 20001231), 0u);
+    EXPECT_EQ(idlib_generate(first.data(), kCount, kStride, 42, 0, 20001231), 0u);
+    EXPECT_EQ(idlib_generate(first.data(), kCount, kStride, 42, 19900101, 0), 0u);
+    EXPECT_EQ(idlib_generate(first.data(), kCount, kStride, 42, 20001231, 19900101), 0u);
+    EXPECT_EQ(idlib_generate(first.data(), kCount, kStride, 42, 19900230, 20001231), 0u);
+}
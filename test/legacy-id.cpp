@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "generator.h"
+#include "legacy-id.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+TEST(legacy_id, upgrade) {
+    EXPECT_EQ(upgrade_legacy_id("110101190810101"), "110101191908101015");
+    EXPECT_EQ(upgrade_legacy_id("110101190810102"), "110101191908101023");
+
+    char out[18];
+    auto id = upgrade_legacy_id("110101190810101", out);
+    EXPECT_TRUE(id.ok());
+    EXPECT_EQ(id.date_of_birth, 19190810u);
+    EXPECT_TRUE(id.is_male());
+    EXPECT_EQ(id.check_code, 5);
+
+    EXPECT_EQ(upgrade_legacy_id("11010119081010", out).error, id_error::kLength);
+    EXPECT_EQ(upgrade_legacy_id("1101011908101X1", out).error, id_error::kCharacter);
+    EXPECT_EQ(upgrade_legacy_id("990101190810101", out).error, id_error::kRegionCode);
+    EXPECT_EQ(upgrade_legacy_id("110101000229101", out).error, id_error::kDateOfBirth);
+    EXPECT_EQ(upgrade_legacy_id("110101190810101", out, {year(1920) / 1 / 1, {}}).error, id_error::kDateOfBirth);
+    EXPECT_THROW(upgrade_legacy_id("990101190810101"), std::invalid_argument);
+}
+
+TEST(legacy_id, batch) {
+    std::mt19937_64 random(3);
+    generator gen(random);
+    std::vector<legacy_id_record> records(1000);
+    std::vector<std::string> expected;
+    for (auto &record : records) {
+        auto id = gen.generate_valid(year(1900) / 1 / 1, year(1999) / 12 / 31);
+        if (random() % 4 == 0) {
+            auto pos = random() % 15;
+            id[pos < 6 ? pos : pos + 2] = "0A9/"[random() % 4];
+            id[17] = mod11_2::do_mod11_2(std::string_view(id).substr(0, 17));
+        }
+        auto legacy = id.substr(0, 6) + id.substr(8, 9);
+        std::copy(legacy.begin(), legacy.end(), record.begin());
+        expected.push_back(id);
+    }
+    std::vector<id_record> out(records.size());
+    std::vector<id_error> errors(records.size());
+    auto valid = upgrade_legacy_ids(records, out, errors.data());
+
+    size_t expected_valid = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        char single[18];
+        auto decoded = upgrade_legacy_id({records[i].data(), records[i].size()}, single);
+        ASSERT_EQ(errors[i], decoded.error) << i;
+        if (decoded.error != id_error::kCharacter) {
+            auto upgraded = std::string_view(out[i].data(), 18);
+            ASSERT_EQ(upgraded, std::string_view(single, 18));
+            ASSERT_EQ(upgraded, expected[i]);
+            ASSERT_EQ(validator::decode(upgraded).error, decoded.error);
+        }
+        expected_valid += decoded.ok();
+    }
+    EXPECT_EQ(valid, expected_valid);
+    EXPECT_GT(valid, 500u);
+}
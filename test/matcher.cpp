@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "matcher.h"
+
+using namespace idlib;
+
+TEST(matcher, match) {
+    std::mt19937 random(42);
+    constexpr char kChars[] = "0123456789Xx*a";
+    std::vector<id_record> records(1000);
+    for (auto &rec : records) {
+        for (size_t i = 0; i < 18; i++) {
+            // mostly digits so that some records match
+            auto c = random() % 64;
+            rec[i] = c < 50 ? static_cast<char>('0' + c % 10) : kChars[c % 14];
+        }
+    }
+    records[7] = {'1', '1', '0', '1', '0', '1', '1', '9', '1', '9', '0', '8', '1', '0', '1', '0', '1', 'X'};
+    for (auto tmpl : {"******************", "11****1919********", "[0-4]*****19[0-2]*08[13579][0-3]**m[0X]",
+                      "*****************X", "[1-9]**************[02468]**"}) {
+        pattern p(tmpl);
+        auto bitmap = match(p, records);
+        size_t expected_count = 0;
+        for (size_t i = 0; i < records.size(); i++) {
+            bool expected = p.match({records[i].data(), 18});
+            expected_count += expected;
+            EXPECT_EQ((bitmap[i / 64] >> (i % 64)) & 1, expected) << tmpl << " " << i;
+        }
+        std::vector<uint64_t> out(bitmap.size());
+        EXPECT_EQ(match(p, std::span(records).subspan(0, records.size()), out.data()), expected_count);
+        EXPECT_EQ((bitmap[0] >> 7) & 1, 1u) << tmpl;
+    }
+}
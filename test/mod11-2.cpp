@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <random>
+#include <string>
+
 #include "mod11-2.h"
 
 using namespace idlib;
@@ -209,3 +212,47 @@ TEST(mod11_2_algo, do_mod11_2_int) {
     EXPECT_EQ(mod11_2::do_mod11_2_int("44532120021112414"), 4);
     EXPECT_EQ(mod11_2::do_mod11_2_int("21062419580708491"), 8);
 }
+
+TEST(mod11_2_algo, do_mod11_2_swar) {
+    std::mt19937_64 random(47);
+    auto random_digits = [&] {
+        std::string id(17, '0');
+        for (auto &c : id) {
+            c = static_cast<char>('0' + random() % 10);
+        }
+        return id;
+    };
+
+    // Every byte value at every position, which covers the digit check exhaustively one byte at a time.
+    for (int n = 0; n < 16; n++) {
+        auto id = random_digits();
+        for (size_t pos = 0; pos < 17; pos++) {
+            auto saved = id[pos];
+            for (int c = 0; c < 256; c++) {
+                id[pos] = static_cast<char>(c);
+                ASSERT_EQ(mod11_2::do_mod11_2_swar(id.data()), mod11_2::do_mod11_2(id.data())) << id << ' ' << c;
+            }
+            id[pos] = saved;
+        }
+    }
+
+    // Every pair of digits at every pair of positions, which covers the weights and their sums.
+    auto id = random_digits();
+    for (size_t a = 0; a < 17; a++) {
+        for (size_t b = a + 1; b < 17; b++) {
+            for (int i = 0; i < 100; i++) {
+                id[a] = static_cast<char>('0' + i / 10);
+                id[b] = static_cast<char>('0' + i % 10);
+                ASSERT_EQ(mod11_2::do_mod11_2_swar(id.data()), mod11_2::do_mod11_2(id.data())) << id;
+            }
+        }
+    }
+
+    for (int n = 0; n < 1000000; n++) {
+        id = random_digits();
+        ASSERT_EQ(mod11_2::do_mod11_2_swar(id.data()), mod11_2::do_mod11_2(id.data())) << id;
+    }
+    EXPECT_EQ(mod11_2::do_mod11_2_swar("99999999999999999"), mod11_2::do_mod11_2("99999999999999999"));
+    EXPECT_EQ(mod11_2::do_mod11_2_swar(std::string_view("3212831930102329")), static_cast<char>(-1));
+    EXPECT_EQ(mod11_2::do_mod11_2_swar(std::string_view("32128319301023294")), 'X');
+}
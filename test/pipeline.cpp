@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "generator.h"
+#include "pipeline.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+namespace {
+
+std::string read_all(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// A path in the temp directory that parallel or repeated runs don't share.
+std::string temp_path(const std::string &name) {
+    std::random_device random;
+    auto unique = std::to_string(uint64_t{random()} << 32 | random());
+    return (std::filesystem::temp_directory_path() / ("idlib_pipeline_" + unique + "_" + name)).string();
+}
+
+} // namespace
+
+TEST(pipeline, validate_file) {
+    auto input = temp_path("input.txt");
+    auto output = temp_path("output.txt");
+
+    std::mt19937 random(42);
+    generator gen(random);
+    std::string expected;
+    pipeline_stats expected_stats{};
+    {
+        std::ofstream out(input, std::ios::binary);
+        for (int i = 0; i < 20000; i++) {
+            bool valid;
+            auto id = gen.generate_all_kinds(valid);
+            auto decoded = validator::decode(id);
+            out << id << (i % 3 == 0 ? "\r\n" : "\n");
+            if (i % 1000 == 0) {
+                out << "\n";
+            }
+            ++expected_stats.lines;
+            if (decoded.ok()) {
+                ++expected_stats.valid;
+                expected += id + "\n";
+            } else {
+                ++expected_stats.errors[static_cast<size_t>(decoded.error)];
+            }
+        }
+        out << "110101191908101015"; // no trailing newline
+        ++expected_stats.lines;
+        ++expected_stats.valid;
+        expected += "110101191908101015\n";
+    }
+
+    for (bool use_io_uring : {true, false}) {
+        for (size_t buffer_size : {size_t{7}, size_t{1000}, size_t{1} << 20}) {
+            pipeline_options options;
+            options.use_io_uring = use_io_uring;
+            options.buffer_size = buffer_size;
+            options.queue_depth = 4;
+            options.threads = 3;
+            auto stats = validate_file(input, output, options);
+            EXPECT_EQ(read_all(output), expected) << use_io_uring << " " << buffer_size;
+            EXPECT_EQ(stats.lines, expected_stats.lines);
+            EXPECT_EQ(stats.valid, expected_stats.valid);
+            EXPECT_EQ(stats.errors, expected_stats.errors);
+            if (!use_io_uring) {
+                EXPECT_FALSE(stats.used_io_uring);
+            }
+        }
+    }
+    EXPECT_THROW(validate_file(temp_path("missing.txt"), output), std::runtime_error);
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+}
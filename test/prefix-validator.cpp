@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "calendar.h"
+#include "details.h"
+#include "generator.h"
+#include "mod11-2.h"
+#include "prefix-validator.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+namespace {
+
+// Whether some valid id in the date range starts with the prefix, by brute force.
+bool completable(std::string_view prefix, year_month_day start, year_month_day end) {
+    if (prefix.size() > 18) {
+        return false;
+    }
+    auto region = prefix.substr(0, detail::kRegionCodeLength);
+    bool region_found = false;
+    for (size_t i = 0; i < detail::kRegionCodeCount && !region_found; i++) {
+        region_found = kRegionCodes[i].starts_with(region);
+    }
+    if (!region_found) {
+        return false;
+    }
+    if (prefix.size() > detail::kDateOfBirthStart) {
+        auto date = prefix.substr(detail::kDateOfBirthStart, detail::kDateOfBirthLength);
+        bool date_found = false;
+        auto last = detail::to_day_serial(end);
+        for (auto serial = detail::to_day_serial(start); serial <= last && !date_found; serial++) {
+            date_found = detail::ymd2str(detail::from_day_serial(serial)).starts_with(date);
+        }
+        if (!date_found) {
+            return false;
+        }
+    }
+    for (size_t i = detail::kRegistryCodeStart; i < std::min<size_t>(prefix.size(), 17); i++) {
+        if (prefix[i] < '0' || prefix[i] > '9') {
+            return false;
+        }
+    }
+    return prefix.size() < 18 || mod11_2::do_mod11_2(prefix.substr(0, 17)) == prefix[17];
+}
+
+} // namespace
+
+TEST(prefix_validator, typing) {
+    prefix_validator v;
+    std::string id = "11010519491231002X";
+    for (size_t i = 0; i < id.size(); i++) {
+        EXPECT_TRUE(v.next() & (id[i] == 'X' ? 0x400 : 1 << (id[i] - '0'))) << i;
+        EXPECT_EQ(v.push(id[i]), id_error::kNone) << i;
+    }
+    EXPECT_TRUE(v.complete());
+    EXPECT_EQ(v.prefix(), id);
+    EXPECT_EQ(v.next(), 0);
+
+    EXPECT_EQ(v.push('1'), id_error::kLength);
+    EXPECT_EQ(v.error_position(), 18u);
+    v.pop();
+    EXPECT_TRUE(v.complete());
+
+    // Backspace over the check code and type a wrong one.
+    v.pop();
+    EXPECT_EQ(v.next(), 0x400);
+    EXPECT_EQ(v.push('1'), id_error::kCheckCode);
+    v.pop();
+    EXPECT_EQ(v.push('x'), id_error::kNone);
+
+    EXPECT_EQ(v.assign("1101"), id_error::kNone);
+    EXPECT_EQ(v.next(), 0b0000000011); // 110101, 110102, 110105, ...
+    EXPECT_EQ(v.assign("11010119490229"), id_error::kDateOfBirth);
+    EXPECT_EQ(v.error_position(), 13u);
+    EXPECT_EQ(v.push('1'), id_error::kDateOfBirth);
+    v.pop();
+    v.pop();
+    EXPECT_TRUE(v.viable());
+    EXPECT_EQ(v.next(), 0b0111111111); // 1949-02-0 to 1949-02-2, 1949 is not a leap year
+    EXPECT_EQ(v.assign("1101a"), id_error::kCharacter);
+    EXPECT_EQ(v.assign("99"), id_error::kRegionCode);
+    EXPECT_EQ(v.error_position(), 0u);
+}
+
+TEST(prefix_validator, date_range) {
+    prefix_validator v({year(1990) / 3 / 15, year(2000) / 10 / 31});
+    v.assign("110101");
+    EXPECT_EQ(v.next(), 0b0000000110);
+    v.assign("1101011990");
+    EXPECT_EQ(v.next(), 0b0000000011);
+    v.assign("11010119900");
+    EXPECT_EQ(v.next(), 0b1111111000);
+    v.assign("110101199003");
+    EXPECT_EQ(v.next(), 0b0000001110);
+    v.assign("1101012000");
+    EXPECT_EQ(v.next(), 0b0000000011);
+    v.assign("11010120001");
+    EXPECT_EQ(v.next(), 0b0000000001);
+    EXPECT_THROW(prefix_validator({year(2000) / 1 / 2, year(2000) / 1 / 1}), std::invalid_argument);
+}
+
+TEST(prefix_validator, brute_force) {
+    auto start = year(1990) / 1 / 1;
+    auto end = year(2000) / 12 / 31;
+    std::mt19937_64 random(23);
+    generator gen(random);
+    prefix_validator v({start, end});
+    for (int n = 0; n < 300; n++) {
+        auto id = gen.generate(generator<std::mt19937_64>::kAll, start, end);
+        id[random() % 18] = "0123456789X"[random() % 11];
+        v.clear();
+        for (size_t i = 0; i < id.size(); i++) {
+            auto viable = v.push(id[i]) == id_error::kNone;
+            ASSERT_EQ(viable, completable(id.substr(0, i + 1), start, end)) << id.substr(0, i + 1);
+            if (!viable) {
+                break;
+            }
+        }
+        // next() agrees with push() for every character.
+        auto prefix = std::string(v.prefix().substr(0, random() % 18));
+        v.assign(prefix);
+        if (!v.viable()) {
+            continue;
+        }
+        auto next = v.next();
+        for (int c = 0; c < 11; c++) {
+            EXPECT_EQ((next >> c) & 1, v.push("0123456789X"[c]) == id_error::kNone) << prefix << c;
+            v.pop();
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_set>
+
+#include "generator.h"
+#include "pseudonymizer.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+namespace {
+
+id_pseudonymizer::key_type make_key(uint8_t seed) {
+    id_pseudonymizer::key_type key;
+    for (size_t i = 0; i < key.size(); i++) {
+        key[i] = static_cast<uint8_t>(seed + i * 37);
+    }
+    return key;
+}
+
+} // namespace
+
+TEST(pseudonymizer, siphash) {
+    // The reference test vectors, key 00 01 .. 0f and message 00 01 .. 0f.
+    EXPECT_EQ(detail::siphash24(0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL, std::array<uint64_t, 0>{}),
+              0x726fdb47dd0e0e31ULL);
+    EXPECT_EQ(detail::siphash24(0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL,
+                                std::array<uint64_t, 2>{0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL}),
+              0x3f2acc7f57c29bdbULL);
+
+    for (uint64_t domain : {1ULL, 7ULL, 1000ULL, 65537ULL}) {
+        detail::keyed_feistel_permutation permutation(domain, make_key(1));
+        std::vector<bool> seen(domain);
+        for (uint64_t i = 0; i < domain; i++) {
+            auto image = permutation(i);
+            ASSERT_LT(image, domain);
+            ASSERT_FALSE(seen[image]);
+            seen[image] = true;
+            ASSERT_EQ(permutation.inverse(image), i);
+        }
+    }
+}
+
+TEST(pseudonymizer, round_trip) {
+    auto start = year(1950) / 1 / 1;
+    auto end = year(2010) / 12 / 31;
+    id_pseudonymizer pseudonymizer(make_key(1), start, end);
+    auto other_key = make_key(1);
+    other_key[15] ^= 1;
+    id_pseudonymizer other(other_key, start, end);
+    std::mt19937_64 random(50);
+    generator gen(random);
+    std::unordered_set<std::string> pseudonyms;
+    for (int i = 0; i < 100000; i++) {
+        auto id = gen.generate_valid(start, end);
+        auto pseudonym = pseudonymizer.pseudonymize(id);
+        auto decoded = validator::decode(pseudonym, {start, end});
+        ASSERT_TRUE(decoded.ok()) << id << ' ' << pseudonym;
+        EXPECT_EQ(decoded.sex, validator::decode(id).sex);
+        EXPECT_NE(pseudonym, other.pseudonymize(id));
+        EXPECT_EQ(pseudonymizer.restore(pseudonym), id);
+        pseudonyms.insert(pseudonym);
+    }
+    // Distinct ids get distinct pseudonyms, the generator may repeat an id but hardly ever does.
+    EXPECT_GT(pseudonyms.size(), 99990u);
+
+    EXPECT_EQ(pseudonymizer.pseudonymize("11010119800101007x"), pseudonymizer.pseudonymize("11010119800101007X"));
+    EXPECT_EQ(id_pseudonymizer(make_key(1), start, end).pseudonymize("110101195001010017"),
+              pseudonymizer.pseudonymize("110101195001010017"));
+    char out[18];
+    EXPECT_EQ(pseudonymizer.pseudonymize("110101191908101015", out), id_error::kDateOfBirth);
+    EXPECT_EQ(pseudonymizer.pseudonymize("110101195001010011", out), id_error::kCheckCode);
+    EXPECT_THROW((void)pseudonymizer.restore("990101195001010017"), std::invalid_argument);
+    EXPECT_THROW(id_pseudonymizer(make_key(1), end, start), std::invalid_argument);
+    // Pseudonyms must not be born in the future.
+    auto tomorrow = year_month_day{sys_days(exhaustor::today()) + days(1)};
+    EXPECT_THROW(id_pseudonymizer(make_key(1), start, tomorrow), std::invalid_argument);
+    EXPECT_NO_THROW(id_pseudonymizer(make_key(1), start, exhaustor::today()));
+}
+
+TEST(pseudonymizer, batch) {
+    std::pair range{year(1900) / 1 / 1, year(2020) / 12 / 31};
+    id_pseudonymizer pseudonymizer(make_key(7), range.first, range.second);
+    std::mt19937_64 random(51);
+    generator gen(random);
+    std::vector<id_record> records(1000);
+    size_t valid = 0;
+    for (auto &record : records) {
+        auto id = random() % 5 ? gen.generate_valid(year(1930) / 1 / 1, year(2020) / 1 / 1)
+                               : gen.generate(generator<std::mt19937_64>::kRegionCode);
+        valid += validator::decode(id, range).ok();
+        std::copy(id.begin(), id.end(), record.begin());
+    }
+    std::vector<id_record> masked(records.size());
+    std::vector<id_error> errors(records.size());
+    EXPECT_EQ(pseudonymizer.pseudonymize(records, masked, errors.data()), valid);
+
+    std::vector<id_record> restored(records.size());
+    EXPECT_EQ(pseudonymizer.restore(masked, restored), valid);
+    for (size_t i = 0; i < records.size(); i++) {
+        std::string_view id(records[i].data(), 18);
+        EXPECT_EQ(errors[i], validator::decode(id, range).error);
+        if (errors[i] == id_error::kNone) {
+            EXPECT_EQ(std::string_view(masked[i].data(), 18), pseudonymizer.pseudonymize(id));
+            EXPECT_EQ(std::string_view(restored[i].data(), 18), id);
+        } else {
+            EXPECT_EQ(std::string_view(masked[i].data(), 18), "000000000000000000");
+        }
+    }
+    EXPECT_THROW(pseudonymizer.pseudonymize(records, std::span(masked).first(10)), std::invalid_argument);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "generator.h"
+#include "scanner.h"
+
+using namespace idlib;
+
+namespace {
+
+std::vector<uint64_t> offsets(const std::vector<id_match> &matches) {
+    std::vector<uint64_t> result;
+    for (auto &match : matches) {
+        result.push_back(match.offset);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(scanner, scan) {
+    std::string text = "user=110101191908101015 ok\n"
+                       "身份证号：32128319301023294X。"
+                       "x110101191908101015 1101011919081010151 110101191908101016 "
+                       "id_110101191908101023 [11010119190810102 3] 32128319301023294x";
+    auto matches = id_scanner::scan(text);
+    std::vector<uint64_t> expected{text.find("110101191908101015"), text.find("32128319301023294X"),
+                                   text.find("32128319301023294x")};
+    EXPECT_EQ(offsets(matches), expected);
+    EXPECT_EQ(matches[0].id.date_of_birth, 19190810u);
+    EXPECT_EQ(matches[1].id.check_code, 10);
+
+    EXPECT_EQ(offsets(id_scanner::scan("110101191908101015")), std::vector<uint64_t>{0});
+    EXPECT_TRUE(id_scanner::scan("").empty());
+}
+
+TEST(scanner, streaming) {
+    std::mt19937_64 random(11);
+    generator gen(random);
+    std::string text;
+    std::vector<uint64_t> expected;
+    while (text.size() < 100000) {
+        switch (random() % 4) {
+        case 0:
+            expected.push_back(text.size());
+            text += gen.generate(generator<std::mt19937_64>::kAll);
+            break;
+        case 1:
+            text += gen.generate(generator<std::mt19937_64>::kCheckCode);
+            break;
+        default:
+            text += std::to_string(random());
+            break;
+        }
+        text += " ,\n\t;"[random() % 5];
+    }
+    EXPECT_EQ(offsets(id_scanner::scan(text)), expected);
+
+    for (size_t chunk : {1, 7, 17, 18, 19, 64, 100, 4096}) {
+        id_scanner scanner;
+        std::vector<id_match> matches;
+        auto collect = [&](const id_match &match) { matches.push_back(match); };
+        for (size_t pos = 0; pos < text.size(); pos += chunk) {
+            scanner.feed(std::string_view(text).substr(pos, chunk), collect);
+        }
+        scanner.finish(collect);
+        EXPECT_EQ(offsets(matches), expected) << chunk;
+    }
+}
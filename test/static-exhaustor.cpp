@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include "static-exhaustor.h"
+
+using namespace idlib;
+using namespace std::chrono;
+
+namespace {
+
+template <fixed_string Template> void expect_same_as_exhaustor(year_month_day start, year_month_day end) {
+    exhaustor dynamic{std::string(Template.view())};
+    auto expected = dynamic.exhaust_all(start, end);
+    EXPECT_EQ(static_exhaustor<Template>::exhaust_all(start, end), expected) << Template.view();
+    uint64_t count = 0;
+    EXPECT_EQ(static_exhaustor<Template>::exhaust([&](std::string_view) { ++count; }, start, end), expected.size());
+    EXPECT_EQ(count, expected.size());
+}
+
+} // namespace
+
+static_assert(static_exhaustor<"11010119******1234">::kPattern.mask(8) == pattern::kDigits);
+static_assert(static_exhaustor<"11010119******1234">::kPattern.mask(14) == 0b10);
+
+TEST(static_exhaustor, same_as_exhaustor) {
+    auto start = year(1990) / 1 / 1;
+    auto end = year(1999) / 12 / 31;
+    expect_same_as_exhaustor<"110101199*0[1-2]******">(start, end);
+    expect_same_as_exhaustor<"11010*199*0[1-2]***[0-3]f*">(start, end);
+    expect_same_as_exhaustor<"1101011990****123X">(start, end);
+    expect_same_as_exhaustor<"11****19900101***[13]">(start, end);
+    expect_same_as_exhaustor<"3[2-3]****19951[0-2]3[01]0*mX">(start, end);
+    expect_same_as_exhaustor<"11010119900229****">(start, end);
+    expect_same_as_exhaustor<"99999919900101****">(start, end);
+    expect_same_as_exhaustor<"110101191908101015">(year(1900) / 1 / 1, end);
+    EXPECT_THROW(static_exhaustor<"110101191908101015">::exhaust_all(end, start), std::invalid_argument);
+}
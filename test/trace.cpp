@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "trace.h"
+
+using namespace idlib;
+
+namespace {
+
+std::string chrome_json() {
+    std::ostringstream out;
+    trace::write_chrome_json(out);
+    return out.str();
+}
+
+size_t count(const std::string &text, const std::string &needle) {
+    size_t n = 0;
+    for (auto pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+// The tids of the events with the given name.
+std::multiset<std::string> tids(const std::string &json, const std::string &name) {
+    std::multiset<std::string> result;
+    auto needle = "\"name\":" + name + ",\"ph\":\"X\",\"pid\":1,\"tid\":";
+    for (auto pos = json.find(needle); pos != std::string::npos; pos = json.find(needle, pos + 1)) {
+        auto begin = pos + needle.size();
+        result.insert(json.substr(begin, json.find(',', begin) - begin));
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(trace, chrome_json) {
+    trace::clear();
+    {
+        trace::scope ignored("ignored");
+    }
+    trace::start();
+    {
+        trace::scope outer("outer");
+        trace::scope inner("inner \"quoted\"");
+    }
+    std::thread([] { trace::scope worker("worker"); }).join();
+    trace::stop();
+
+    auto json = chrome_json();
+    EXPECT_EQ(json.find("\"ignored\""), std::string::npos);
+    auto outer = tids(json, "\"outer\"");
+    ASSERT_EQ(outer.size(), 1u) << json;
+    EXPECT_EQ(tids(json, "\"inner \\\"quoted\\\"\""), outer) << json;
+    // The worker exited before the dump, its events are kept under its own tid.
+    auto worker = tids(json, "\"worker\"");
+    ASSERT_EQ(worker.size(), 1u) << json;
+    EXPECT_NE(worker, outer) << json;
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+
+    trace::clear();
+    EXPECT_EQ(count(chrome_json(), "\"name\""), 0u);
+}
+
+TEST(trace, recycled_buffers) {
+    trace::clear();
+    trace::start();
+    std::thread([] { trace::scope first("first"); }).join();
+    for (int i = 0; i < 10; i++) {
+        std::thread([] { trace::scope next("next"); }).join();
+    }
+    trace::stop();
+
+    // Each thread reuses the buffer of the one before it, which keeps its events.
+    auto json = chrome_json();
+    auto first = tids(json, "\"first\"");
+    ASSERT_EQ(first.size(), 1u) << json;
+    auto next = tids(json, "\"next\"");
+    EXPECT_EQ(next.size(), 10u) << json;
+    EXPECT_EQ(next.count(*first.begin()), 10u) << json;
+    trace::clear();
+}
+
+TEST(trace, ring_buffer) {
+    trace::clear();
+    trace::start();
+    for (uint64_t i = 0; i < trace::kEventsPerThread + 10; i++) {
+        trace::record("event", i * 1000, i * 1000 + 1500);
+    }
+    trace::stop();
+
+    // The oldest 10 events were overwritten.
+    auto json = chrome_json();
+    EXPECT_EQ(count(json, "\"name\":\"event\""), trace::kEventsPerThread);
+    EXPECT_EQ(json.find("\"ts\":9.000,"), std::string::npos);
+    EXPECT_NE(json.find("\"ts\":10.000,\"dur\":1.500}"), std::string::npos);
+    trace::clear();
+}
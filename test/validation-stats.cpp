@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <thread>
+
+#include "generator.h"
+#include "validation-stats.h"
+
+using namespace idlib;
+
+TEST(validation_stats, merge) {
+    std::mt19937 random(9);
+    generator gen(random);
+    std::vector<std::string> ids;
+    for (int i = 0; i < 40000; i++) {
+        ids.push_back(gen.generate_all_kinds());
+    }
+    ids.emplace_back("1101011919081010");
+    ids.emplace_back("11010119190A101015");
+
+    validation_counts expected;
+    for (auto &id : ids) {
+        auto result = validator::decode(id);
+        ++expected.total;
+        expected.valid += result.ok();
+        ++expected.errors[static_cast<size_t>(result.error)];
+    }
+    expected.errors[0] = 0;
+
+    constexpr size_t kThreads = 4;
+    validation_stats stats(kThreads);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < kThreads; t++) {
+            workers.emplace_back([&, t] {
+                for (size_t i = t; i < ids.size(); i += kThreads) {
+                    stats.validate(t, ids[i]);
+                }
+            });
+        }
+    }
+    auto counts = stats.merge();
+    EXPECT_EQ(counts.total, expected.total);
+    EXPECT_EQ(counts.valid, expected.valid);
+    EXPECT_EQ(counts.errors, expected.errors);
+    EXPECT_EQ(counts.failures_by_position[11], 1u);
+    EXPECT_EQ(counts.failures_by_position[6], expected.errors[static_cast<size_t>(id_error::kDateOfBirth)]);
+    EXPECT_EQ(counts.failures_by_position[17], expected.errors[static_cast<size_t>(id_error::kCheckCode)]);
+
+    uint64_t province_total = 0, province_failures = 0;
+    for (size_t i = 0; i < validation_counts::kProvinces; i++) {
+        province_total += counts.total_by_province[i];
+        province_failures += counts.failures_by_province[i];
+    }
+    EXPECT_EQ(province_total, counts.total);
+    EXPECT_EQ(province_failures, counts.total - counts.valid);
+
+    stats.reset();
+    EXPECT_EQ(stats.merge().total, 0u);
+    EXPECT_THROW(validation_stats(0), std::invalid_argument);
+}
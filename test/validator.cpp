@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include "region-codes.h"
+#include "validator.h"
+
+using namespace idlib;
+
+TEST(validator, decode) {
+    auto id = validator::decode("110101191908101015");
+    EXPECT_TRUE(id.ok());
+    EXPECT_EQ(kRegionCodes[id.region_index], "110101");
+    EXPECT_EQ(id.date_of_birth, 19190810u);
+    EXPECT_EQ(id.year(), 1919);
+    EXPECT_EQ(id.month(), 8u);
+    EXPECT_EQ(id.day(), 10u);
+    EXPECT_TRUE(id.is_male());
+    EXPECT_EQ(id.check_code, 5);
+
+    id = validator::decode("110101191908101023");
+    EXPECT_TRUE(id.ok());
+    EXPECT_FALSE(id.is_male());
+
+    id = validator::decode("32128319301023294x");
+    EXPECT_TRUE(id.ok());
+    EXPECT_EQ(id.check_code, 10);
+}
+
+TEST(validator, decode_errors) {
+    EXPECT_EQ(validator::decode("11010119190810101").error, id_error::kLength);
+    EXPECT_EQ(validator::decode("1101011919081010X5").error, id_error::kCharacter);
+    EXPECT_EQ(validator::decode("11010119190810101Y").error, id_error::kCharacter);
+    EXPECT_EQ(validator::decode("000000191908101015").error, id_error::kRegionCode);
+    EXPECT_EQ(validator::decode("110101190002291014").error, id_error::kDateOfBirth);
+    EXPECT_EQ(validator::decode("110101191908101016").error, id_error::kCheckCode);
+    EXPECT_EQ(validator::decode("110105200002291235").error, id_error::kNone);
+
+    using namespace std::chrono;
+    auto range = std::pair{year(1920) / 1 / 1, year(2000) / 1 / 1};
+    EXPECT_EQ(validator::decode("110101191908101015", range).error, id_error::kDateOfBirth);
+    EXPECT_EQ(validator::decode("110105200002291235", range).error, id_error::kDateOfBirth);
+    EXPECT_EQ(validator::decode("450102198001010015", range).error, id_error::kNone);
+}
+
+TEST(validator, validate_basic) {
+    EXPECT_TRUE(validator::validate_basic("110101191908101015"));
+    EXPECT_TRUE(validator::validate_basic("32128319301023294X"));
+    EXPECT_TRUE(validator::validate_basic("32128319301023294x"));
+    EXPECT_FALSE(validator::validate_basic("321283193010232945"));
+    EXPECT_FALSE(validator::validate_basic("1101011919081010X5"));
+    EXPECT_FALSE(validator::validate_basic("11010119190810101"));
+    // A non-digit before the check code must not compare equal to the last byte.
+    EXPECT_FALSE(validator::validate_basic("abcdefghijklmnopq\xff"));
+    EXPECT_FALSE(validator::validate_basic("1101011919081010a\xff"));
+    EXPECT_FALSE(validator::validate_basic("1101011919081010X\xff"));
+}
+
+TEST(validator, validate_non_digit_before_check_code) {
+    using namespace std::chrono;
+    std::pair range{year(1900) / 1 / 1, year(2000) / 1 / 1};
+    validator valid("110101191908101015", range);
+    EXPECT_TRUE(valid.validate());
+    for (auto id : {"11010119190810X015", "110101191908101X15", "1101011919081010XX"}) {
+        validator v(id, range);
+        EXPECT_FALSE(v.validate()) << id;
+        EXPECT_EQ(v.where().first, std::string_view(id).find('X')) << id;
+    }
+}
+
+TEST(validator, misplaced_x) {
+    using namespace std::chrono;
+    std::pair range{year(1900) / 1 / 1, year(2000) / 1 / 1};
+    // An 'X' in the region code, the date of birth and the sequence code, with a valid check code otherwise.
+    for (auto id : {"1X0101191908101015", "11010119X908101015", "110101191908101x15"}) {
+        auto position = std::string_view(id).find_first_of("Xx");
+        EXPECT_EQ(validator::decode(id, range).error, id_error::kCharacter) << id;
+        validator v(id, range);
+        EXPECT_FALSE(v.validate()) << id;
+        EXPECT_EQ(v.where(), std::make_pair(position, position)) << id;
+        EXPECT_EQ(v.errmsg(), "The id must only contain digits before the check code.") << id;
+    }
+    validator bad_check_code("11010119190810101a", range);
+    EXPECT_FALSE(bad_check_code.validate());
+    EXPECT_EQ(bad_check_code.where(), std::make_pair(size_t{17}, size_t{17}));
+    EXPECT_EQ(validator::decode("11010119190810101a", range).error, id_error::kCharacter);
+}
@@ -1,11 +1,48 @@
 add_requires("gtest")
 
-target("idlib")
-    set_kind("static")
+option("avx2")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build the SIMD kernels with AVX2")
+option_end()
+
+option("trace")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Record the stages of validator, generator and exhaustor for trace::dump(), see src/trace.h")
+option_end()
+
+local function add_library_settings()
     set_languages("c++20")
     add_files("src/**.cpp")
+    add_includedirs("src", {public = true})
+    if is_arch("x86_64", "x64") then
+        add_vectorexts("ssse3")
+    end
+    if has_config("avx2") then
+        add_vectorexts("avx2")
+    end
+    if has_config("trace") then
+        add_defines("IDLIB_TRACE", {public = true})
+    end
+    if is_plat("linux") then
+        add_syslinks("pthread", {public = true})
+    end
+end
+
+target("idlib")
+    set_kind("static")
     add_headerfiles("src/**.h")
-    add_includedirs("src")
+    add_library_settings()
+
+-- C ABI for FFI callers, see src/idlib-c.h
+target("idlib_c")
+    set_kind("shared")
+    set_symbols("hidden")
+    add_headerfiles("src/idlib-c.h")
+    add_defines("IDLIB_C_SHARED", {public = true})
+    add_defines("IDLIB_C_BUILD")
+    add_library_settings()
 
 target("idlib_test")
     set_kind("binary")
@@ -13,4 +50,14 @@ target("idlib_test")
     add_files("test/**.cpp")
     add_deps("idlib")
     add_packages("gtest")
-    add_includedirs("src")
\ No newline at end of file
+    add_includedirs("src")
+
+for _, file in ipairs(os.files("bench/*.cpp")) do
+    target("bench_" .. path.basename(file))
+        set_kind("binary")
+        set_languages("c++20")
+        set_default(false)
+        add_files(file)
+        add_deps("idlib")
+        add_includedirs("src")
+end